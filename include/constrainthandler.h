@@ -14,13 +14,22 @@ class ConstraintHandler {
 		std::vector<double> const ub;
 		int const D;
 		int nCorrected;
+		std::vector<int> resampleHistogram; // Candidates accepted after k resamples, at k
 		bool isFeasible(Solution const * const p) const;
+		void countResamples(int const resamples);
+		static double* position(Solution* const p); // Raw row for the repair kernels
 	public:
 		ConstraintHandler(std::vector<double> const lb, std::vector<double> const ub): lb(lb), ub(ub), D(lb.size()), nCorrected(0){};
 		virtual ~ConstraintHandler(){};
 		virtual bool resample(Solution* const p, int const resamples);
+		virtual bool canResample() const { return false; } // Whether resample ever asks for a new candidate
+		virtual bool rejectsInfeasible(int const resamples) const { return false; } // Whether any violation is resampled at this count
+		bool isFeasible(int const dim, double const x) const { return !(x < lb[dim] - 1.0e-12 || x > ub[dim] + 1.0e-12); }
 		virtual void penalize(Solution* const p){};
+		virtual bool screen(Solution* const p){ return false; } // Penalizes p before its evaluation, true when it needs none
 		int getCorrections() const;
+		std::vector<int> const& getResampleHistogram() const;
+		void restoreCounts(int const corrections, std::vector<int> const& resampleHistogram); // Undoes the counting of repairs that were thrown away
 };
 
 class DEConstraintHandler : virtual public ConstraintHandler {
@@ -29,17 +38,23 @@ class DEConstraintHandler : virtual public ConstraintHandler {
 		virtual ~DEConstraintHandler(){};
 		virtual void repairDE(Solution* const p, Solution const * const base, Solution const* const target){}; // DE constraint handler
 		virtual void repair(Solution* const p){};// Generic constraint handler
+		// Whole populations at once, row k with bases[k] and targets[k]
+		virtual void repairDEAll(std::vector<Solution*> const& p, std::vector<Solution const*> const& bases, std::vector<Solution*> const& targets);
+		virtual void repairAll(std::vector<Solution*> const& p);
 };
 
 class PSOConstraintHandler : virtual public ConstraintHandler {
 	protected:
 		void repairVelocityPost(Particle* const p, int const i); // Change velocity after changing position
+		static double* velocity(Particle* const p);
 	public:
 		PSOConstraintHandler(std::vector<double>const lb,std::vector<double>const ub): ConstraintHandler(lb,ub){};
 		virtual ~PSOConstraintHandler(){};
 		virtual void repairPSO(Particle* const p){};// PSO constraint handler
 		virtual void repairVelocityPre(Particle* const p){}; // For constraint handlers that fix the velocity
+		virtual bool repairsVelocityPre() const { return false; } // Otherwise velocity and position are updated in one pass
 		virtual void repair(Particle* const p){}; // Generic constraint handler
+		virtual void repairAll(std::vector<Particle*> const& p); // A whole swarm at once
 };
 
 extern std::map<std::string, std::function<DEConstraintHandler* (std::vector<double>, std::vector<double>)>> const deCHs;
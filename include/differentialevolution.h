@@ -3,6 +3,8 @@
 #include "mutationmanager.h"
 #include "crossovermanager.h"
 #include "deadaptationmanager.h"
+#include "logsettings.h"
+#include "evaluationsettings.h"
 
 template <typename T>
 class IOHprofiler_problem;
@@ -19,10 +21,14 @@ struct DEConfig {
 class DifferentialEvolution {
 	private:
 		DEConfig const config;
+		LogSettings logSettings;
+		EvaluationSettings evaluationSettings;
 	public:
 		DifferentialEvolution(DEConfig const config);
 		void run(std::shared_ptr<IOHprofiler_problem<double> > const problem, 
     		std::shared_ptr<IOHprofiler_csv_logger> const logger,
     		int const evalBudget, int const popSize) const;
+		void setLogSettings(LogSettings const logSettings);
+		void setEvaluationSettings(EvaluationSettings const evaluationSettings);
 		std::string getIdString() const;
 };
@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include "evaluationsettings.h"
+
+template <typename T>
+class IOHprofiler_problem;
+class IOHprofiler_csv_logger;
+class PerformanceAggregator;
+
+// Collects the IOHprofiler logger info of every evaluation in a run and hands
+// it in batches, in the order the evaluations happened, to the csv logger
+// and/or a PerformanceAggregator. Screens and cache hits charged against the
+// budget are handed on as evaluations too, and records count what was spent.
+class EvaluationBuffer {
+	private:
+		std::shared_ptr<IOHprofiler_problem<double> > const problem;
+		std::shared_ptr<IOHprofiler_csv_logger> const logger;
+		PerformanceAggregator* const aggregator;
+		int const evalBudget;
+		int const capacity;
+		int recordSize;
+		int size;
+		std::vector<double> records;
+		std::vector<double> info;
+		std::mutex mutex;
+
+		EvaluationSettings const settings;
+		EvaluationCounters counters;
+
+		// Exact repeats by bit pattern, the most recently used first
+		struct Cached {
+			std::vector<double> x;
+			double fitness;
+		};
+		struct BitHash {
+			std::size_t operator()(std::vector<double> const* const x) const;
+		};
+		struct BitEqual {
+			bool operator()(std::vector<double> const* const a, std::vector<double> const* const b) const;
+		};
+		std::list<Cached> cache;
+		std::unordered_map<std::vector<double> const*, std::list<Cached>::iterator, BitHash, BitEqual> cached;
+
+		void flushLocked();
+		double evaluateLocked(std::vector<double> const& x);
+		void chargeLocked();
+	public:
+		EvaluationBuffer(std::shared_ptr<IOHprofiler_problem<double> > const problem,
+			std::shared_ptr<IOHprofiler_csv_logger> const logger, PerformanceAggregator* const aggregator = NULL,
+			int const evalBudget = 0, EvaluationSettings const settings = EvaluationSettings(), int const capacity = 4096);
+		~EvaluationBuffer();
+		EvaluationBuffer(EvaluationBuffer const&) = delete;
+		EvaluationBuffer& operator=(EvaluationBuffer const&) = delete;
+
+		double evaluate(std::vector<double> const& x); // Evaluates x on the problem and records the evaluation
+		void flush(); // Called at generation boundaries
+		void screen(bool const charge); // Records a candidate rejected without an evaluation
+		int getScreened() const;
+		int getSpent() const; // Evaluations plus charged screens and cache hits
+		EvaluationCounters const& getCounters() const;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// What an EvaluationBuffer did besides evaluating, and how often the constraint handlers resampled
+struct EvaluationCounters {
+	EvaluationCounters(): screened(0), charged(0), hits(0), misses(0), spent(0){}
+
+	int screened; // Candidates rejected without an evaluation
+	int charged; // Screens and cache hits counted against the budget
+	int hits; // Points found in the cache
+	int misses; // Points evaluated while the cache was on
+	int spent; // Evaluations plus charged screens and cache hits, see EvaluationBuffer::getSpent
+	std::vector<int> resamples; // Candidates accepted after k resamples, at k, see ConstraintHandler::getResampleHistogram
+
+	void addResamples(std::vector<int> const& histogram){
+		if (resamples.size() < histogram.size())
+			resamples.resize(histogram.size(), 0);
+		for (unsigned int k = 0; k < histogram.size(); k++)
+			resamples[k] += histogram[k];
+	}
+	void save(std::string const filename) const; // The counts, then the resample histogram, replaced in one rename
+	void load(std::string const filename); // Adds the counts of an earlier save, if any
+};
+
+// Controls how an algorithm spends its evaluation budget
+struct EvaluationSettings {
+	EvaluationSettings(): screen(false), budget("C"), cacheSize(0), cacheBudget("C"), counters(NULL),
+		trialsPerTarget(4), threads(1){}
+
+	bool screen; // Let penalizing constraint handlers reject candidates before they are evaluated
+	std::string budget; // What a screened candidate costs: "C" charged as an evaluation, "F" free
+	int cacheSize; // Points remembered for exact repeats, least recently used first out, 0 disables
+	std::string cacheBudget; // What a cache hit costs: "C" charged as an evaluation, "F" free
+	EvaluationCounters* counters; // Optional, the counts of every run are added to it, not owned
+	std::string surrogate; // Model that picks which DE trials are evaluated, empty disables, see surrogate.h
+	int trialsPerTarget; // Trials built per target while the surrogate screens, the most promising one is evaluated
+	int threads; // For the surrogate predictions
+};
@@ -6,6 +6,8 @@
 #include "crossovermanager.h"
 //#include "selectionmanager.h"
 #include "constrainthandler.h"
+#include "logsettings.h"
+#include "evaluationsettings.h"
 #include <memory>
 
 struct HybridConfig {
@@ -27,6 +29,8 @@ struct HybridConfig {
 class HybridAlgorithm {
 	protected:
 		HybridConfig const config;
+		LogSettings logSettings;
+		EvaluationSettings evaluationSettings;
 	public:
 		HybridAlgorithm(HybridConfig const config);
 		virtual ~HybridAlgorithm() = 0;
@@ -35,5 +39,7 @@ class HybridAlgorithm {
 		std::shared_ptr<IOHprofiler_csv_logger> const logger, int const evalBudget, 
 		int const popSize, std::map<int,double> const particleUpdateParams) = 0;
 
+		void setLogSettings(LogSettings const logSettings);
+		void setEvaluationSettings(EvaluationSettings const evaluationSettings);
 		virtual std::string getIdString() const = 0;
 };
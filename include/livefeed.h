@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Live population frames in a POSIX shared memory ring buffer. One process
+// publishes, any number of readers attach by name. Frames use the trajectory
+// layout (N*D float positions, particle-major, then N float fitnesses). The
+// writer never waits: a reader that falls behind loses frames, and every slot
+// carries a sequence number so a frame overwritten while being copied is
+// detected and skipped.
+struct LiveFeedHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t N;
+	uint32_t D;
+	uint32_t slots;
+	int32_t problem;
+	std::atomic<uint32_t> closed; // Set when the writer is done; readers should attach again
+	std::atomic<uint64_t> published; // Number of frames published so far
+};
+
+constexpr char LIVEFEED_MAGIC[8] = {'P','S','O','D','E','L','I','V'};
+constexpr uint32_t LIVEFEED_VERSION = 1;
+
+class LiveFeedWriter {
+	private:
+		std::string const name;
+		int const N;
+		int const D;
+		int const slots;
+		std::size_t length;
+		char* data;
+		LiveFeedHeader* header;
+
+		float* begin(); // Marks the next slot as being written and returns its frame
+		void commit();
+	public:
+		// An empty name disables the feed
+		LiveFeedWriter(std::string const name, int const N, int const D, int const problem, int const slots = 64);
+		~LiveFeedWriter(); // Marks the feed closed and unlinks it
+		LiveFeedWriter(LiveFeedWriter const&) = delete;
+		LiveFeedWriter& operator=(LiveFeedWriter const&) = delete;
+
+		bool enabled() const;
+
+		template <typename T>
+		void publish(std::vector<T*> const& pop) {
+			if (data == NULL)
+				return;
+			float* const frame = begin();
+			for (int i = 0; i < N; i++){
+				for (int j = 0; j < D; j++)
+					frame[i * D + j] = pop[i]->getX(j);
+				frame[N * D + i] = pop[i]->getFitness();
+			}
+			commit();
+		}
+};
+
+class LiveFeedReader {
+	private:
+		std::string const name;
+		std::size_t length;
+		char* data;
+		LiveFeedHeader const* header;
+		uint64_t next;
+		uint64_t lost;
+
+		void detach();
+	public:
+		LiveFeedReader(std::string const name);
+		~LiveFeedReader();
+		LiveFeedReader(LiveFeedReader const&) = delete;
+		LiveFeedReader& operator=(LiveFeedReader const&) = delete;
+
+		bool attach(); // Returns false while no writer has created the feed
+		bool attached() const;
+		bool closed() const;
+		int getN() const;
+		int getD() const;
+		int getProblem() const;
+		// Copies the oldest frame not yet read that is still in the ring, or the
+		// newest one if latest is set; returns false if there is no new frame
+		bool read(std::vector<float>& frame, bool const latest = false);
+		uint64_t dropped() const; // Frames lost because the reader fell behind
+};
@@ -1,19 +1,26 @@
+#pragma once
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include "suite_bbob_legacy_code.hpp"
 #include "util.h" 
+#include "logsink.h"
 class Solution;
 
 class Logger { // Used to log arbitrary stuff
 	private:
-		std::ofstream out;
+		LogSink* const sink;
+		std::ostringstream out;
+		void commit();
 	public:
-		Logger(std::string filename): out(filename, std::ios::app){};
+		Logger(std::string const filename, std::string const sinkType = "F"): sink(logSinks.at(sinkType)(filename, true)){};
 		~Logger();
 
 		template <typename T>
 		void log(std::vector<T*> const pop) {
+			if (!sink->enabled())
+				return;
 			for (T* s : pop){
 				for (double x : s->getX()){
 					out << x << " ";
@@ -22,6 +29,7 @@ class Logger { // Used to log arbitrary stuff
 				out << "\n";
 			}
 			out << "\n";
+			commit();
 		}
 
 		void log(int const function, int const D, std::vector<double> const percCorrected, 
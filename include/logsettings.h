@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+
+class PerformanceAggregator;
+class RunArchiveWriter;
+
+// Controls the extra data an algorithm writes next to the IOHprofiler logs
+struct LogSettings {
+	LogSettings(): sink("F"), animationTrigger("K1"), parameterTrigger("K10"), csv(true), aggregator(NULL), archive(NULL){}
+
+	std::string sink; // Where extra data goes: "F" files, "M" memory or "N" nowhere, see logsink.h
+	std::string animationTrigger; // Snapshot trigger for population frames, see snapshottrigger.h
+	std::string parameterTrigger; // Snapshot trigger for DE parameter (F, Cr) logs
+	std::string liveFeed; // Shared memory name live population frames are published under, empty disables, see livefeed.h
+	bool csv; // Pass every evaluation to the IOHprofiler csv logger
+	PerformanceAggregator* aggregator; // Optional online ERT/ECDF aggregation, not owned
+	RunArchiveWriter* archive; // Optional sweep archive receiving the final result of every run, not owned
+};
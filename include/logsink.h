@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <functional>
+
+// Destination of the extra data written by Logger and TrajectoryWriter
+class LogSink {
+	public:
+		virtual ~LogSink(){};
+		virtual bool enabled() const { return true; } // Disabled sinks let writers skip formatting
+		virtual bool good() const { return true; } // False once a write did not go through
+		virtual void write(char const* data, std::size_t const size) = 0;
+		void write(std::string const& s){ write(s.data(), s.size()); }
+};
+
+// Sinks are created from a name and whether existing data is appended to
+extern std::map<std::string, std::function<LogSink* (std::string const, bool const)>> const logSinks;
+
+class FileSink : public LogSink {
+	private:
+		std::string const filename;
+		bool const append;
+		std::ofstream out;
+		bool failed; // Reported once, later writes are dropped
+
+		void fail(std::string const what);
+	public:
+		FileSink(std::string const filename, bool const append): filename(filename), append(append), failed(false){};
+		~FileSink();
+		bool good() const { return !failed; }
+		void write(char const* data, std::size_t const size);
+};
+
+class NullSink : public LogSink {
+	public:
+		NullSink(std::string const filename, bool const append){};
+		bool enabled() const { return false; }
+		void write(char const* data, std::size_t const size){};
+};
+
+class MemorySink : public LogSink { // Keeps the data in process, per name
+	private:
+		std::string const name;
+		static std::map<std::string, std::string> store;
+		static std::mutex mutex;
+	public:
+		MemorySink(std::string const name, bool const append);
+		void write(char const* data, std::size_t const size);
+		static std::string contents(std::string const name);
+		static void clear();
+};
@@ -8,14 +8,28 @@
 #include "rng.h"
 #include "util.h"
 
+// The random choices behind one mutant, so it can be built, and rebuilt,
+// without drawing again
+struct MutationDraw {
+	Solution const* base; // Handed to the DE handlers
+	double const* x[6]; // Rows the mutant combines
+	double F;
+	double w[3]; // Strategy specific weights
+	bool variant; // Strategy specific, e.g. trigonometric instead of rand/1
+};
+
 class MutationManager {
 	protected:
 		int const D;
 		DEConstraintHandler* const deCH;
 		std::vector<Solution*> genomes;
 		std::vector<double> Fs;
-		virtual Solution* mutate(int const i) const=0;
+		virtual void draw(int const i, MutationDraw& d)=0; // Takes all random numbers of mutant i, and may fill rows d points to
+		virtual void build(MutationDraw const& d, double* const x, int const from, int const to) const=0; // Dimensions from .. to-1
 		virtual void preMutation(){};
+		bool buildFeasible(MutationDraw const& d, double* const x) const; // Stops at the first block that violates a bound
+		static double* position(Solution* const s);
+		static double const* position(Solution const* const s);
 	public:
 		MutationManager(int const D, DEConstraintHandler * const deCH):D(D), deCH(deCH){};
 		virtual ~MutationManager(){};
@@ -27,7 +41,8 @@ extern std::map<std::string, std::function<MutationManager* (int const, DEConstr
 class Rand1MutationManager : public MutationManager {
 	public:
 		Rand1MutationManager(int const D, DEConstraintHandler* const deCH): MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class TTB1MutationManager : public MutationManager {
@@ -36,7 +51,8 @@ class TTB1MutationManager : public MutationManager {
 		void preMutation();
 	public:
 		TTB1MutationManager(int const D, DEConstraintHandler* const deCH): MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class TTB2MutationManager : public MutationManager {
@@ -45,13 +61,15 @@ class TTB2MutationManager : public MutationManager {
 		void preMutation();
 	public:
 		TTB2MutationManager(int const D, DEConstraintHandler* const deCH): MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class TTPB1MutationManager : public MutationManager {
 	public:
 		TTPB1MutationManager(int const D, DEConstraintHandler* const deCH): MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class Best1MutationManager: public MutationManager {
@@ -60,7 +78,8 @@ class Best1MutationManager: public MutationManager {
 		void preMutation();
 	public:
 		Best1MutationManager(int const D, DEConstraintHandler* const deCH):MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class Best2MutationManager: public MutationManager {
@@ -69,47 +88,55 @@ class Best2MutationManager: public MutationManager {
 		void preMutation();
 	public:
 		Best2MutationManager(int const D, DEConstraintHandler* const deCH):MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class Rand2MutationManager: public MutationManager {
 	public:
 		Rand2MutationManager(int const D, DEConstraintHandler* const deCH):MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class Rand2DirMutationManager : public MutationManager {
 	public:
 		Rand2DirMutationManager(int const D, DEConstraintHandler* const deCH):MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class NSDEMutationManager : public MutationManager {
 	public:
 		NSDEMutationManager(int const D, DEConstraintHandler* const deCH):MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class TrigonometricMutationManager : public MutationManager {
 	private:
 		double const gamma;
-		Solution* trigonometricMutation(int const i) const;
-		Solution* rand1Mutation(int const i) const;
+		std::vector<Solution*> centroids; // Base of every trigonometric mutant, built with it
+		void preMutation();
 	public:
 		TrigonometricMutationManager(int const D, DEConstraintHandler* const deCH): MutationManager(D, deCH), gamma(0.05){};
-		Solution* mutate(int const i) const;
+		~TrigonometricMutationManager();
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class TwoOpt1MutationManager : public MutationManager {
 	public:
 		TwoOpt1MutationManager(int const D, DEConstraintHandler* const deCH): MutationManager(D, deCH) {};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class TwoOpt2MutationManager : public MutationManager {
 	public:
 		TwoOpt2MutationManager(int const D, DEConstraintHandler* const deCH): MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class ProximityMutationManager : public MutationManager {
@@ -119,7 +146,8 @@ class ProximityMutationManager : public MutationManager {
 		void preMutation();
 	public:
 		ProximityMutationManager(int const D, DEConstraintHandler* const deCH): MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
 
 class RankingMutationManager : public MutationManager {
@@ -129,5 +157,6 @@ class RankingMutationManager : public MutationManager {
 		Solution* pickRanked(std::vector<Solution*> & possibilities) const;
 	public:
 		RankingMutationManager(int const D, DEConstraintHandler* const deCH): MutationManager(D, deCH){};
-		Solution* mutate(int const i) const;
+		void draw(int const i, MutationDraw& d);
+		void build(MutationDraw const& d, double* const x, int const from, int const to) const;
 };
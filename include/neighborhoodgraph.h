@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Particle;
+
+// Directed neighborhood graph of a swarm in compressed sparse row form: the
+// neighbors of particle i are neighbors[offsets[i]] .. neighbors[offsets[i+1]-1],
+// sorted by index. Dense graphs also keep an adjacency bitset, so membership
+// tests are O(1) there and a binary search otherwise. Edges are changed in
+// bulk, every change rebuilds the rows in O(N + E).
+//
+// The graph also logs which particles improved their pbest, so a particle
+// only has to look at the neighbors that improved since its last visit
+// instead of its whole row.
+//
+// Fully connected graphs store no edges: every row is all particles but
+// itself, and the swarm-wide best is kept as one index instead of a log.
+// Graphs of disjoint cliques store only the cluster of every particle.
+class NeighborhoodGraph {
+	public:
+		typedef std::pair<int,int> Edge; // Particle, neighbor
+
+		class Row {
+			private:
+				int const* first;
+				int const* last;
+				int const* skip; // Entry left out, NULL for none
+			public:
+				class iterator {
+					private:
+						int const* at;
+						int const* skip;
+					public:
+						iterator(int const* at, int const* skip): at(at != skip ? at : at + 1), skip(skip){};
+						int operator*() const { return *at; }
+						iterator& operator++(){ at++; if (at == skip) at++; return *this; }
+						bool operator!=(iterator const& other) const { return at != other.at; }
+						bool operator==(iterator const& other) const { return at == other.at; }
+				};
+
+				Row(int const* first, int const* last, int const* skip = NULL): first(first), last(last), skip(skip){};
+				iterator begin() const { return iterator(first, skip); }
+				iterator end() const { return iterator(last, skip); }
+				int size() const { return last - first - (skip != NULL); }
+				int operator[](int const i) const { return first[i + (skip != NULL && first + i >= skip)]; }
+		};
+	private:
+		std::vector<Particle*> const& particles;
+		int const N;
+		std::vector<int> offsets;
+		std::vector<int> neighbors;
+		std::vector<uint64_t> bits; // N rows of `words` words, empty unless dense
+		int const words;
+
+		enum Layout { ROWS, COMPLETE, CLUSTERS };
+		Layout layout;
+		std::vector<int> all; // 0 .. N-1, the rows of a complete graph
+		int best; // Best pbest of a complete graph
+		std::vector<int> cluster; // Of every particle
+		std::vector<int> members; // Particles sorted by cluster, then index
+		std::vector<int> clusterStart; // Of every cluster in members
+		std::vector<int> position; // Of every particle in members
+		int clusterEdges;
+
+		std::vector<int> improved; // Particles whose pbest improved, in order
+		int improvedBase; // Log position of improved[0]
+		std::vector<int> seen; // Log position up to which each particle has looked, -1 once it lost neighbors, -2 to rescan its row
+
+		void build(std::vector<Edge> const& edges); // Edges may be unsorted and hold duplicates
+		void buildBits();
+		void rewired();
+		void setComplete();
+		void materialize(); // Stores the rows of a complete or clustered graph
+	public:
+		NeighborhoodGraph(std::vector<Particle*> const& particles);
+
+		int size() const;
+		int getNumberOfEdges() const;
+		Row getNeighbors(int const i) const;
+		Particle* getParticle(int const i) const;
+		bool isNeighbor(int const i, int const j) const;
+		bool isDense() const;
+		bool isComplete() const;
+
+		void assign(std::vector<Edge> const& edges); // Replaces all edges
+		void assignComplete(); // Connects every particle to all others
+		void assignClusters(std::vector<int> const& clusterOf); // Connects the particles of each cluster, ids are 0 .. K-1
+		void add(std::vector<Edge> const& edges);
+		void remove(std::vector<Edge> const& edges);
+		void clear();
+
+		void markImproved(int const i);
+		bool isRewired(int const i) const; // Lost neighbors since the last forImprovedNeighbors for i
+		// Calls f(j) for the neighbors j of i that improved since the last call
+		// for i, or all of them after its row changed. Walks the log or the row,
+		// whichever is shorter.
+		template <typename F>
+		void forImprovedNeighbors(int const i, F f){
+			if (layout == COMPLETE){
+				seen[i] = 0;
+				if (best != i)
+					f(best);
+				return;
+			}
+			Row const row = getNeighbors(i);
+			int const from = seen[i];
+			int const end = improvedBase + improved.size();
+			seen[i] = end;
+			if (from < 0 || end - from >= row.size()){
+				for (int const j : row)
+					f(j);
+			} else {
+				for (int k = from - improvedBase; k < (int)improved.size(); k++)
+					if (isNeighbor(i, improved[k]))
+						f(improved[k]);
+			}
+		}
+};
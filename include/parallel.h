@@ -0,0 +1,31 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Calls f(i) for every i in [0, n), spread over at most `threads` threads
+// (0 uses every hardware thread). Indices are handed out one at a time, so
+// unevenly sized work items still balance.
+template <typename F>
+void parallelFor(int const n, int threads, F f){
+	if (threads <= 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::min(threads, n);
+
+	if (threads <= 1){
+		for (int i = 0; i < n; i++)
+			f(i);
+		return;
+	}
+
+	std::atomic<int> next(0);
+	std::vector<std::thread> pool;
+	for (int t = 0; t < threads; t++)
+		pool.emplace_back([&](){
+			for (int i = next++; i < n; i = next++)
+				f(i);
+		});
+	for (std::thread& t : pool)
+		t.join();
+}
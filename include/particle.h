@@ -4,6 +4,7 @@
 #include "particleupdatesettings.h"
 #include "IOHprofiler_experimenter.h"
 #include "solution.h"
+#include "neighborhoodgraph.h"
 
 class ParticleUpdateManager;
 
@@ -11,15 +12,22 @@ class Particle : public Solution {
 	private:		
 		std::vector<double> v;
 		std::vector<double> p;		
-		std::vector<double> g;
+		std::vector<double> xNext, vNext; // Scratch rows for candidates of resampling handlers, empty until needed
 
 		double pbest;
-		double gbest;
+		Particle const* best; // Best in the neighborhood including this one, whose p is g
+		std::vector<double> const* g; // &best->p, handed to the update manager
 
-		std::vector<Particle*> neighborhood;
-		ParticleUpdateManager* particleUpdateManager;
+		NeighborhoodGraph* neighborhood; // Owned by the topology manager
+		int index; // Of this particle in the neighborhood graph
+		ParticleUpdateManager* const particleUpdateManager; // Shared by the swarm
 		ParticleUpdateSettings const * const settings;
 		PSOConstraintHandler* const psoCH;
+
+		void move(double const progress);
+		void propose(double const progress);
+		friend class ParticleUpdateManager;
+		friend class PSOConstraintHandler;
 	public:
 		Particle(int const D, ParticleUpdateSettings const*const particleUpdateSettings);
 		Particle(Particle const & other);
@@ -31,15 +39,18 @@ class Particle : public Solution {
 		void setXandUpdateV(std::vector<double> const x, double const fitness); 
 		double getGbest() const;
 		double getPbest() const;
-		std::vector<double> getG() const;
-		std::vector<double> getP() const;
+		std::vector<double> const& getG() const;
+		std::vector<double> const& getP() const;
 		double getP(int const i) const;
 		void updatePbest();
 		void updateGbest();
 		void updateVelocityAndPosition(double const progress);
-		void addNeighbor(Particle* const neighbor);
-		void removeNeighbor(Particle* const neighbor);
-		void removeAllNeighbors();
-		bool isNeighbor(Particle* particle) const;
+		// Moves the whole swarm in one sweep: all random factors are drawn first,
+		// in particle order, then the moves run in blocks over `threads` threads
+		static void updateSwarm(std::vector<Particle*> const& particles, double const progress, int const threads);
+		void setNeighborhood(NeighborhoodGraph* const neighborhood, int const index);
+		NeighborhoodGraph const* getNeighborhood() const;
+		NeighborhoodGraph::Row getNeighbors() const;
+		int getIndex() const;
 		int getNumberOfNeighbors() const;
 };
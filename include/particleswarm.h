@@ -3,10 +3,13 @@
 #include <fstream>
 #include "particleupdatesettings.h"
 #include "topologymanager.h"
+#include "logsettings.h"
+#include "evaluationsettings.h"
 #include <memory>
 
 struct Problem;
 class Particle;
+class PSOConstraintHandler;
 struct ParticleUpdateSettings;
 template <typename T> 
 class IOHprofiler_problem;
@@ -22,6 +25,9 @@ struct PSOConfig {
 class ParticleSwarm {
 	private:
 		PSOConfig const config;
+		LogSettings logSettings;
+		EvaluationSettings evaluationSettings;
+		int threads; // For the synchronous update sweep
 
 		void runSynchronous(std::shared_ptr<IOHprofiler_problem<double> > const problem, 
     		std::shared_ptr<IOHprofiler_csv_logger> const logger,
@@ -30,6 +36,10 @@ class ParticleSwarm {
 		void runAsynchronous(std::shared_ptr<IOHprofiler_problem<double> > const problem, 
     		std::shared_ptr<IOHprofiler_csv_logger> const logger,
     		int const evalBudget, int const popSize, std::map<int,double> const particleUpdateParams);
+
+		// Hands the final result of a run to LogSettings::archive, if any
+		void archive(std::shared_ptr<IOHprofiler_problem<double> > const problem,
+			std::vector<Particle*> const& particles, PSOConstraintHandler const* const psoCH) const;
 	public:
 		ParticleSwarm(PSOConfig const config);
 		~ParticleSwarm();
@@ -38,6 +48,9 @@ class ParticleSwarm {
     		std::shared_ptr<IOHprofiler_csv_logger> const logger,
     		int const evalBudget, int const popSize, std::map<int,double> const particleUpdateParams);
 
+		void setLogSettings(LogSettings const logSettings);
+		void setEvaluationSettings(EvaluationSettings const evaluationSettings);
+		void setThreads(int const threads);
 		void reset();
 		std::string getIdString() const;
 };
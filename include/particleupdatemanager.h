@@ -8,88 +8,109 @@ class ConstraintHandler;
 struct ParticleUpdateSettings;
 class Particle;
 
+// The update rule of a swarm, with its parameters resolved once. One manager
+// serves every particle of the swarm and keeps per particle only what has to
+// outlive a call, under the particle's index.
 class ParticleUpdateManager {
 	protected:
-		std::vector<double> & x;
-		std::vector<double> & v;
-		std::vector<double> const& p;
-		std::vector<double> const& g;
 		int const D;
+
+		// The position and velocity of a particle are only written by its rule
+		static std::vector<double>& position(Particle& particle);
+		static std::vector<double>& velocity(Particle& particle);
 	public:
-		ParticleUpdateManager(std::vector<double>& x, std::vector<double>& v,
-			std::vector<double>const& p, std::vector<double>const& g);
+		ParticleUpdateManager(int const D);
 		virtual ~ParticleUpdateManager();
 
-		//This constructor is used for ParticleUpdateManagers that do not use a 
-		//velocity vector.
-		ParticleUpdateManager(std::vector<double>& x, std::vector<double> & p, std::vector<double>& g);
+		virtual void updateVelocity(Particle& particle, double const progress);
+		virtual void updatePosition(Particle& particle);
+		virtual void update(Particle& particle, double const progress); // Both, in one pass where the rule allows
+		virtual void propose(Particle& particle, double const progress, std::vector<double>& xNew, std::vector<double>& vNew); // Like update, leaving x and v as they are
+
+		// Managers that draw ahead split update into draw, which takes all the
+		// random numbers, and apply, which does not touch the RNG; a swarm can
+		// then draw for every particle first and apply in parallel
+		virtual bool drawsAhead() const;
+		virtual void draw(Particle const& particle);
+		virtual void apply(Particle& particle, double const progress);
+};
 
-		virtual void updateVelocity(double const progress);
-		virtual void updatePosition();
+class DrawAheadManager : public ParticleUpdateManager {
+	private:
+		std::vector<std::vector<double> > drawn; // Random numbers of every particle index
+	protected:
+		std::vector<double>& drawnFor(Particle const& particle); // Grows the table, only called by draw
+		std::vector<double> const& drawnBy(Particle const& particle) const;
+		virtual void move(Particle& particle, double const progress, double* const xOut, double* const vOut) = 0; // Velocity only if xOut is NULL
+	public:
+		DrawAheadManager(int const D);
+		void updateVelocity(Particle& particle, double const progress);
+		void update(Particle& particle, double const progress);
+		void propose(Particle& particle, double const progress, std::vector<double>& xNew, std::vector<double>& vNew);
+		bool drawsAhead() const;
+		void apply(Particle& particle, double const progress);
 };
 
-extern std::map<std::string, std::function<ParticleUpdateManager* (std::vector<double>&, std::vector<double>&,
-		std::vector<double>const&, std::vector<double>const&, std::map<int,double>, std::vector<Particle*>&)>> const updateManagers;
+extern std::map<std::string, std::function<ParticleUpdateManager* (int const, std::map<int,double>)>> const updateManagers;
 
-class InertiaWeightManager : public ParticleUpdateManager{
+class InertiaWeightManager : public DrawAheadManager {
 	private:
 		double const phi1;
 		double const phi2;
 		double w;
-
+		double const vMax; // Velocity clamp, infinite unless S_VMAX is given
+		void move(Particle& particle, double const progress, double* const xOut, double* const vOut);
 	public:
-		InertiaWeightManager(std::vector<double>& x, std::vector<double>& v,
-			std::vector<double>const& p, std::vector<double>const& g, std::map<int, double> paramaters, std::vector<Particle*>& neighborhood);
-		void updateVelocity(double const progress);
+		InertiaWeightManager(int const D, std::map<int, double> paramaters);
+		void draw(Particle const& particle);
 };
 
-class DecrInertiaWeightManager : public ParticleUpdateManager {
+class DecrInertiaWeightManager : public DrawAheadManager {
 	private:
 		double const phi1;
 		double const phi2;
 		double const wMin;
 		double const wMax;
+		double const vMax;
+		void move(Particle& particle, double const progress, double* const xOut, double* const vOut);
 	public:
-		DecrInertiaWeightManager(std::vector<double>& x, std::vector<double>& v,
-			std::vector<double>const& p, std::vector<double>const& g, std::map<int, double> paramaters, std::vector<Particle*>& neighborhood);
-		void updateVelocity(double const progress);
+		DecrInertiaWeightManager(int const D, std::map<int, double> paramaters);
+		void draw(Particle const& particle);
 
 };
 
-class ConstrictionCoefficientManager : public ParticleUpdateManager {
+class ConstrictionCoefficientManager : public DrawAheadManager {
 	private:
 		double const phi1;
 		double const phi2;
 		double const chi;
-	public: 
+		double const vMax;
+		void move(Particle& particle, double const progress, double* const xOut, double* const vOut);
+	public:
 
-		ConstrictionCoefficientManager(std::vector<double> & x, std::vector<double> & v,
-			std::vector<double>const& p, std::vector<double>const& g, std::map<int, double> paramaters, std::vector<Particle*>& neighborhood);
+		ConstrictionCoefficientManager(int const D, std::map<int, double> paramaters);
 
-		void updateVelocity(double const progress);
+		void draw(Particle const& particle);
 };
 
-class FIPSManager : public ParticleUpdateManager {
+class FIPSManager : public DrawAheadManager {
 	private:
 		double const phi;
 		double const chi;
-		std::vector<Particle*>& neighborhood;
+		void move(Particle& particle, double const progress, double* const xOut, double* const vOut);
 	public:
-		FIPSManager(std::vector<double> & x, std::vector<double> & v,
-			std::vector<double>const& p, std::vector<double>const& g, 
-			std::map<int, double> paramaters, std::vector<Particle*>& neighborhood);
-		void updateVelocity(double const progress);
+		FIPSManager(int const D, std::map<int, double> paramaters);
+		void draw(Particle const& particle); // One weight per neighbor
 };
 
 
 
-class BareBonesManager : public ParticleUpdateManager {
+class BareBonesManager : public DrawAheadManager {
 	private:
-		
-	public: 
-		BareBonesManager(std::vector<double> & x, std::vector<double> & v,
-			std::vector<double>const& p, std::vector<double>const& g, 
-			std::map<int, double> paramaters, std::vector<Particle*>& neighborhood);
-		void updatePosition();
-		void updateVelocity(double const progress);
+		void move(Particle& particle, double const progress, double* const xOut, double* const vOut);
+	public:
+		BareBonesManager(int const D, std::map<int, double> paramaters);
+		void draw(Particle const& particle); // D standard normals
+		void updatePosition(Particle& particle);
+		void updateVelocity(Particle& particle, double const progress);
 };
@@ -19,6 +19,8 @@ constexpr double VMAX_PHI2_DEFAULT = 1.49618;
 constexpr double CC_PHI1_DEFAULT = 2.05;
 constexpr double CC_PHI2_DEFAULT = 2.05;
 constexpr double FIPS_PHI_DEFAULT = 4.1;
+constexpr double MS_CLUSTER_SIZE_DEFAULT = 3;
+constexpr double MS_REGROUP_PERIOD_DEFAULT = 5;
 
 enum Setting {
 	S_INER_PHI1,
@@ -34,17 +36,18 @@ enum Setting {
 	S_VMAX,
 	S_FIPS_PHI,
 	S_DINER_W_START, // Starting value of decreasing inertia weight
-	S_DINER_W_END	// Ending value of decreasing inertia weight
+	S_DINER_W_END,	// Ending value of decreasing inertia weight
+	S_MS_CLUSTER_SIZE, // Particles per cluster of the dynamic multi-swarm topology
+	S_MS_REGROUP_PERIOD // Iterations between regroupings of the dynamic multi-swarm topology
 };
 
 struct ParticleUpdateSettings {
-	ParticleUpdateSettings(std::string const managerType, std::map<int, double> const parameters, PSOConstraintHandler*const psoCH)
-		:managerType(managerType), parameters(parameters), psoCH(psoCH){
+	ParticleUpdateSettings(ParticleUpdateManager*const manager, PSOConstraintHandler*const psoCH)
+		:manager(manager), psoCH(psoCH){
 	};
 
 	ParticleUpdateSettings(){}
 
-	std::string managerType;
-	std::map<int, double> parameters;
+	ParticleUpdateManager* manager; // One for the whole swarm
 	PSOConstraintHandler* psoCH;
 };
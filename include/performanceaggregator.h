@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+#include "logsink.h"
+
+// Aggregates hitting times of one configuration over all runs as evaluations
+// stream in. Per (function, dimension) it keeps the sums needed for the
+// expected running time (ERT) of every target and the area under the ECDF.
+// Runs have to follow each other: the state of the current run is not
+// synchronized, so runs that overlap in time need an aggregator each.
+// The sums can be saved and loaded again, so a resumed sweep adds its runs
+// to those of the earlier invocations instead of starting over.
+class PerformanceAggregator {
+	private:
+		struct Cell {
+			int runs;
+			std::vector<double> evaluations; // Sum of evaluations spent per target, hit or not
+			std::vector<int> successes;
+			double area;
+		};
+
+		std::string const config;
+		std::vector<double> const targets; // Precisions (f - f_opt), descending
+		std::map<std::pair<int,int>, Cell> cells;
+		std::mutex mutex;
+
+		// State of the current run
+		int function;
+		int D;
+		int budget;
+		double optimum;
+		int nextTarget;
+		std::vector<int> hits;
+	public:
+		PerformanceAggregator(std::string const config, std::vector<double> const targets = defaultTargets());
+		static std::vector<double> defaultTargets(); // 51 targets from 1e2 to 1e-8
+
+		void startRun(int const function, int const D, double const optimum, int const budget);
+		void observe(int const evaluations, double const bestSoFar);
+		void endRun(int const evaluations);
+
+		double ert(int const function, int const D, int const target);
+		double ecdfArea(int const function, int const D);
+		void write(LogSink* const sink); // One line per (function, dimension)
+		void save(std::string const filename); // The sums at full precision, replaced in one rename
+		void load(std::string const filename); // Adds the sums of an earlier save, if any
+};
@@ -44,9 +44,12 @@ class ConservatismRepair : public DEConstraintHandler {
 
 // Particle Swarm Optimization
 class HyperbolicRepair : public PSOConstraintHandler {
+	private:
+		std::vector<double> center;
 	public:
-		HyperbolicRepair(std::vector<double> const lb, std::vector<double> const ub):ConstraintHandler(lb,ub), PSOConstraintHandler(lb, ub){};
+		HyperbolicRepair(std::vector<double> const lb, std::vector<double> const ub);
 		void repairVelocityPre(Particle * const p);
+		bool repairsVelocityPre() const { return true; }
 };
 
 class PBestDimRepair : public PSOConstraintHandler {
@@ -57,10 +60,14 @@ class PBestDimRepair : public PSOConstraintHandler {
 
 // Generic
 class ResamplingRepair : public DEConstraintHandler, public PSOConstraintHandler  {
+	private:
+		static int const maxResamples = 100; // Then the candidate is projected
 	public:
 		ResamplingRepair(std::vector<double> const lb, std::vector<double> const ub)
 			:ConstraintHandler(lb,ub), DEConstraintHandler(lb,ub), PSOConstraintHandler(lb, ub){};
 		bool resample(Solution * const p, int const resamples);
+		bool canResample() const { return true; }
+		bool rejectsInfeasible(int const resamples) const { return resamples < maxResamples; }
 };
 
 class DeathPenalty : public DEConstraintHandler, public PSOConstraintHandler {
@@ -68,6 +75,7 @@ class DeathPenalty : public DEConstraintHandler, public PSOConstraintHandler {
 		DeathPenalty(std::vector<double>const lb,std::vector<double>const ub):ConstraintHandler(lb,ub), 
 			DEConstraintHandler(lb,ub), PSOConstraintHandler(lb,ub){};
 		void penalize(Solution* const p);
+		bool screen(Solution* const p);
 };
 
 class ReinitializationRepair : public DEConstraintHandler, public PSOConstraintHandler {
@@ -84,6 +92,8 @@ class ProjectionRepair : public DEConstraintHandler, public PSOConstraintHandler
 			:ConstraintHandler(lb,ub), DEConstraintHandler(lb, ub), PSOConstraintHandler(lb,ub){};
 		void repair(Solution* const p);
 		void repair(Particle* const p);
+		void repairAll(std::vector<Solution*> const& p);
+		void repairAll(std::vector<Particle*> const& p);
 };
 
 class ReflectionRepair : public DEConstraintHandler, public PSOConstraintHandler {
@@ -92,23 +102,30 @@ class ReflectionRepair : public DEConstraintHandler, public PSOConstraintHandler
 			:ConstraintHandler(lb,ub), DEConstraintHandler(lb, ub), PSOConstraintHandler(lb,ub){}; 
 		void repair(Solution* const p);
 		void repair(Particle* const p);
+		void repairAll(std::vector<Solution*> const& p);
+		void repairAll(std::vector<Particle*> const& p);
 };
 
 class WrappingRepair : public DEConstraintHandler, public PSOConstraintHandler {
+	private:
+		std::vector<double> width;
 	public:
-		WrappingRepair(std::vector<double> const lb, std::vector<double> const ub):ConstraintHandler(lb,ub), DEConstraintHandler(lb, ub), 
-		PSOConstraintHandler(lb,ub){}; 
+		WrappingRepair(std::vector<double> const lb, std::vector<double> const ub);
 		void repair(Solution* const p);
 		void repair(Particle* const p);
+		void repairAll(std::vector<Solution*> const& p);
+		void repairAll(std::vector<Particle*> const& p);
 };
 
 class TransformationRepair : public DEConstraintHandler, public PSOConstraintHandler { //Adapted from https://github.com/psbiomech/c-cmaes
 	private:
 		std::vector<double> al, au, xlo, xhi, r;
-		bool shift(Solution* const p);
-		bool shift(Particle* const p);
+		template <bool hasVelocity>
+		int transform(double* const x, double* const v) const; // Returns the number of repaired dimensions
 	public:
 		TransformationRepair(std::vector<double> const lb, std::vector<double> const ub);
 		void repair(Solution* const p);
 		void repair(Particle* const p);
+		void repairAll(std::vector<Solution*> const& p);
+		void repairAll(std::vector<Particle*> const& p);
 };
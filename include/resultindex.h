@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Final result of one run, as far as comparing configurations is concerned
+struct ResultRow {
+	int32_t config; // Index into the configuration names of the owning source or index
+	int32_t function;
+	int32_t D;
+	int32_t evaluations;
+	double bestF;
+};
+
+// All runs of one configuration on one function and dimension
+struct ResultGroup {
+	int config;
+	int function;
+	int D;
+	int runs;
+	double best;
+	double median;
+	double rank; // Rank of the median among the configurations on this function and dimension, ties averaged
+	bool win; // Best median on this function and dimension
+};
+
+// Index over result files: scratch/extra_data .dat files, IOHprofiler .dat
+// files and run archives. The rows parsed from every file are cached in an
+// index file and a file is only parsed again when its size or modification
+// time changed, so repeated queries over a sweep only read the index.
+// IOHprofiler rows only count for (configuration, function, dimension) cells
+// that no extra_data file or archive covers, as a sweep logs every run to both.
+class ResultIndex {
+	private:
+		struct Source {
+			std::string path;
+			uint64_t size;
+			int64_t mtime;
+			std::vector<std::string> configs;
+			std::vector<ResultRow> rows;
+		};
+		std::vector<Source> sources;
+		std::vector<std::string> configs;
+		std::vector<ResultRow> rows;
+
+		static void parse(Source& source);
+	public:
+		bool load(std::string const filename); // Returns false if there is no usable index
+		void save(std::string const filename) const;
+		// Brings the index up to date with the result files in paths (files or
+		// directories) and selects their rows; returns the number of files parsed
+		int update(std::vector<std::string> const& paths, int const threads = 0);
+
+		std::vector<std::string> const& getConfigs() const;
+		std::vector<ResultRow> const& getRows() const;
+
+		// Best and median fitness per configuration, function and dimension, with
+		// ranks and wins per function and dimension filled in
+		std::vector<ResultGroup> groups(std::function<bool (ResultRow const&)> const filter, int const threads = 0) const;
+};
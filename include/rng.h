@@ -8,10 +8,14 @@ class RNG {
 		std::bernoulli_distribution boolDist;
 	public:
 		RNG();
+		void seed(unsigned int const s); // Makes the following draws reproducible
 		bool randBool();
 		double randDouble(double start, double end);
+		void uniformFill(std::vector<double>& values, double const start, double const end); // Uniform in [start, end) at 32 bit resolution, faster than randDouble
+		void uniformFill(double* const first, double* const last, double const start, double const end);
 		int randInt(int start, int end);
 		double normalDistribution(double mean, double stdDev);
+		void normalFill(double* const first, double* const last); // Standard normal, one 32 bit draw per value
 		double cauchyDistribution(double a, double b);
 		void shuffle(std::vector<double>::iterator first, std::vector<double>::iterator last);
 };
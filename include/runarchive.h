@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <fstream>
+
+// Final result of one run, as logged to scratch/extra_data/<id>.dat
+struct RunRecord {
+	std::string config;
+	int function;
+	int D;
+	std::vector<double> percCorrected;
+	std::vector<double> bestX;
+	double bestF;
+	int evaluations;
+};
+
+// A row of scratch/extra_data/<id>.dat: function D percCorrected[k] bestX[D]
+// bestF numEvals. DE logs one correction rate per 100000 evaluations and at
+// least 3, so k grows with the budget. Returns false for other rows.
+bool parseExtraData(std::vector<double> const& values, RunRecord& record);
+int extraDataRates(std::vector<double> const& values); // k, or -1 for other rows
+
+// Columnar archive holding the runs of a whole sweep. Integer columns are
+// delta/zigzag varint coded, double columns are XOR coded against the
+// previous value, and an index maps every configuration to its rows.
+// The archive is written on close. A resumed writer first loads the archive
+// and the journal its predecessor left, and journals every row it adds at
+// full precision, so an interrupted sweep keeps the runs it finished.
+class RunArchiveWriter {
+	private:
+		std::string const filename;
+		bool const resume;
+		std::ofstream journal; // <config> and an extra data row per line, removed on close
+		std::vector<std::string> configs;
+		std::map<std::string, int> configIds;
+		std::vector<int> config, function, D, evaluations, rates;
+		std::vector<double> percCorrected, bestX, bestF;
+		std::mutex mutex;
+		bool closed;
+
+		void addLocked(RunRecord const& record);
+	public:
+		RunArchiveWriter(std::string const filename, bool const resume = false);
+		~RunArchiveWriter();
+		void add(RunRecord const& record);
+		int importLegacy(std::string const datFile, std::string const config); // Returns the number of rows read
+		void close();
+};
+
+class RunArchiveReader {
+	private:
+		std::vector<std::string> configs;
+		std::map<std::string, std::vector<int> > index;
+		std::vector<int> config, function, D, evaluations;
+		std::vector<std::size_t> offsets; // Start of every row in bestX
+		std::vector<std::size_t> rateOffsets; // Start of every row in percCorrected
+		std::vector<double> percCorrected, bestX, bestF;
+	public:
+		RunArchiveReader(std::string const filename);
+		int size() const;
+		std::vector<std::string> getConfigs() const;
+		std::vector<int> const& rows(std::string const config) const; // Row numbers of a configuration
+		RunRecord getRow(int const i) const;
+		std::string getConfig(int const i) const;
+		int getFunction(int const i) const;
+		int getD(int const i) const;
+		double getBestF(int const i) const;
+		int getEvaluations(int const i) const;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <string>
+#include <functional>
+#include "util.h"
+
+struct SnapshotState {
+	int iteration;
+	int evaluations;
+	int evalBudget;
+	double bestFitness;
+	double diversity; // Only computed for triggers that need it
+};
+
+// Decides at which iterations a population or parameter snapshot is logged
+class SnapshotTrigger {
+	protected:
+		virtual bool check(SnapshotState const& state) = 0;
+	public:
+		virtual ~SnapshotTrigger(){};
+		virtual bool needsDiversity() const { return false; }
+
+		template <typename T>
+		bool fire(int const iteration, int const evaluations, int const evalBudget, std::vector<T*> const& pop){
+			SnapshotState const state = {iteration, evaluations, evalBudget, getBest(pop)->getFitness(),
+				needsDiversity() ? diversity(pop) : 0.};
+			return check(state);
+		}
+};
+
+// Triggers are specified as a key followed by a parameter, e.g. "K10" or "F200"
+SnapshotTrigger* createSnapshotTrigger(std::string const spec);
+extern std::map<std::string, std::function<SnapshotTrigger* (double const)>> const snapshotTriggers;
+
+class EveryKTrigger : public SnapshotTrigger { // Every k-th iteration
+	private:
+		int const k;
+	protected:
+		bool check(SnapshotState const& state);
+	public:
+		EveryKTrigger(double const k): k(std::max(1, (int)k)){};
+};
+
+class LogSpacedTrigger : public SnapshotTrigger { // Log-spaced in evaluations, n snapshots per decade
+	private:
+		double const perDecade;
+		int step;
+	protected:
+		bool check(SnapshotState const& state);
+	public:
+		LogSpacedTrigger(double const perDecade): perDecade(std::max(1., perDecade)), step(0){};
+};
+
+class ImprovementTrigger : public SnapshotTrigger { // Whenever the best fitness improves by a relative margin
+	private:
+		double const margin;
+		double best;
+	protected:
+		bool check(SnapshotState const& state);
+	public:
+		ImprovementTrigger(double const margin);
+};
+
+class DiversityCollapseTrigger : public SnapshotTrigger { // Whenever diversity drops by a factor since the last snapshot
+	private:
+		double const factor;
+		double reference;
+	protected:
+		bool check(SnapshotState const& state);
+	public:
+		DiversityCollapseTrigger(double const factor);
+		bool needsDiversity() const { return true; }
+};
+
+class FixedFramesTrigger : public SnapshotTrigger { // A fixed number of frames, evenly spaced over the budget
+	private:
+		int const frames;
+		int taken;
+	protected:
+		bool check(SnapshotState const& state);
+	public:
+		FixedFramesTrigger(double const frames): frames(std::max(1, (int)frames)), taken(0){};
+};
@@ -1,12 +1,15 @@
 #pragma once
 #include <vector>
 #include <IOHprofiler_experimenter.h>
+#include "evaluationbuffer.h"
 
 class Solution {
 	protected:
 		std::vector<double> x;
 		bool evaluated;
 		double fitness;
+		friend class ConstraintHandler;
+		friend class MutationManager;
 	public:
 		Solution(int const D);
 		virtual ~Solution();
@@ -17,7 +20,7 @@ class Solution {
 		void setX(std::vector<double> x);
 		std::vector<double> getX() const;
 		double getX(int const dim) const;
-		double evaluate (std::shared_ptr<IOHprofiler_problem<double> > problem, std::shared_ptr<IOHprofiler_csv_logger> logger);
+		double evaluate(EvaluationBuffer& evaluations);
 		double getFitness() const;
 		void setFitness(double const d);
 		std::string positionString() const;
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <string>
+#include <functional>
+
+class Solution;
+
+// A cheap model of the objective, learned one evaluated point at a time.
+// predict is const and thread safe, so a batch can be spread over threads.
+class Surrogate {
+	protected:
+		int const D;
+	public:
+		Surrogate(int const D);
+		virtual ~Surrogate();
+
+		virtual void add(std::vector<double> const& x, double const fitness) = 0;
+		virtual bool ready() const = 0; // Whether enough points were added for predictions to mean anything
+		virtual double predict(std::vector<double> const& x) const = 0;
+		void predict(std::vector<Solution*> const& points, std::vector<double>& predicted, int const threads) const;
+};
+
+extern std::map<std::string, std::function<Surrogate* (int const)>> const surrogates;
+
+// Inverse distance weighted mean over the k nearest points of a bounded archive
+class KNNSurrogate : public Surrogate {
+	private:
+		int const k;
+		int const capacity; // Then the oldest point is overwritten
+		std::vector<double> points; // Row major
+		std::vector<double> fitness;
+		int next; // Row the next point goes to
+	public:
+		KNNSurrogate(int const D);
+		void add(std::vector<double> const& x, double const fitness);
+		bool ready() const;
+		double predict(std::vector<double> const& x) const;
+};
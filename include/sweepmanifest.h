@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+// A configuration file and the number of independent runs to give the experimenter for it
+struct SweepBatch {
+	std::string configFile;
+	int runs;
+};
+
+// One run of a sweep, identified by its content
+struct WorkUnit {
+	std::string config;
+	int problem;
+	int instance;
+	int D;
+	int run; // Repetition of this problem, instance and dimension
+	uint64_t seed; // Seed of the sweep
+
+	uint64_t hash() const;
+	uint32_t rngSeed() const; // Seed for the run itself, so a rerun of a unit is reproducible
+};
+
+// Records which work units of a sweep have completed, so an interrupted sweep
+// can be restarted without redoing them. Every completed unit is appended to
+// the manifest file as one checksummed line with a single write, so a crash
+// leaves at most one torn line, which is ignored on the next start. The first
+// line holds the seed of the sweep, drawn when the manifest is created.
+class SweepManifest {
+	private:
+		std::string const filename;
+		uint64_t seed;
+		std::unordered_set<uint64_t> done;
+		std::map<std::tuple<std::string, int, int, int>, int> runs; // Units handed out per config, problem, instance and dimension
+		std::mutex mutex;
+
+		void append(std::string const record);
+		WorkUnit unit(std::string const config, int const problem, int const instance, int const D, int const run) const;
+	public:
+		SweepManifest(std::string const filename); // Loads the seed and the units completed so far
+		SweepManifest(SweepManifest const&) = delete;
+		SweepManifest& operator=(SweepManifest const&) = delete;
+
+		// Batches that make the experimenter run exactly the units of a config that are not done:
+		// the template itself on a fresh sweep, one batch per unfinished problem, instance and
+		// dimension on a resumed one
+		std::vector<SweepBatch> pending(std::string const templateFile, std::string const config, int const runs);
+		// The next unit that is not done for a config on a problem
+		WorkUnit next(std::string const config, int const problem, int const instance, int const D);
+		void complete(WorkUnit const& unit, int const evaluations, double const bestF); // Evaluations as charged against the budget
+		int size();
+};
@@ -3,19 +3,22 @@
 #include<functional>
 #include<map>
 #include<random>
+#include "neighborhoodgraph.h"
 
 class Particle;
 
 class TopologyManager {
 	protected:
 		std::vector<Particle*>const &particles;
+		NeighborhoodGraph graph; // Shared by the particles, which look up their neighbors in it
 	public:
 		TopologyManager(std::vector<Particle*> const & particles);
 		virtual ~TopologyManager();
 		virtual void update(double progress);
+		NeighborhoodGraph const& getGraph() const;
 };
 
-extern std::map<std::string, std::function<TopologyManager* (std::vector<Particle*> const&)>> const topologies;
+extern std::map<std::string, std::function<TopologyManager* (std::vector<Particle*> const&, std::map<int,double> const)>> const topologies;
 
 class LbestTopologyManager : public TopologyManager {
 	public:
@@ -66,10 +69,12 @@ class DecreasingTopologyManager : public TopologyManager {
 class MultiSwarmTopologyManager : public TopologyManager {
 	private:
 		int const clusterSize;
+		int const period; // Iterations between regroupings
 		int count;
-		void createClusters();
+		std::vector<int> clusterOf; // Cluster of every particle, shuffled to regroup
+		void regroup();
 	public:
-		MultiSwarmTopologyManager(std::vector<Particle*> const & particles);
+		MultiSwarmTopologyManager(std::vector<Particle*> const & particles, std::map<int,double> parameters);
 		void update(double progress);
 };
 
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "logsink.h"
+
+// Binary population trajectory: a header followed by fixed-size frames.
+// Every frame holds N*D positions (particle-major) followed by N fitness
+// values, all stored with the same precision (4 or 8 bytes).
+struct TrajectoryHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t N;
+	uint32_t D;
+	uint32_t precision;
+	int32_t problem;
+	uint32_t configLength; // Length of the config string that follows the header
+};
+
+constexpr char TRAJECTORY_MAGIC[8] = {'P','S','O','D','E','T','R','J'};
+constexpr uint32_t TRAJECTORY_VERSION = 1;
+
+class TrajectoryWriter {
+	private:
+		LogSink* const sink;
+		int const N;
+		int const D;
+		int const precision;
+		int frames;
+		std::vector<char> frame;
+
+		void put(int const index, double const value);
+		void written(); // Counts the frame if the sink took it
+	public:
+		TrajectoryWriter(LogSink* const sink, int const N, int const D, int const problem,
+				std::string const config, int const precision = 4); // Takes ownership of the sink
+		~TrajectoryWriter();
+
+		template <typename T>
+		void log(std::vector<T*> const& pop) {
+			if (!sink->enabled() || !sink->good())
+				return;
+			for (int i = 0; i < N; i++){
+				for (int j = 0; j < D; j++)
+					put(i * D + j, pop[i]->getX(j));
+				put(N * D + i, pop[i]->getFitness());
+			}
+			sink->write(frame.data(), frame.size());
+			written();
+		}
+
+		int size() const;
+};
+
+// A view on a single frame inside a memory-mapped trajectory file
+class TrajectoryFrame {
+	private:
+		char const* data;
+		int const N;
+		int const D;
+		int const precision;
+		double get(int const index) const;
+	public:
+		TrajectoryFrame(char const* data, int const N, int const D, int const precision)
+			: data(data), N(N), D(D), precision(precision){};
+		double getX(int const particle, int const dim) const;
+		std::vector<double> getX(int const particle) const;
+		double getFitness(int const particle) const;
+};
+
+class TrajectoryReader {
+	private:
+		int fd;
+		char const* data;
+		std::size_t length;
+		TrajectoryHeader header;
+		std::string config;
+		std::size_t dataOffset;
+		std::size_t frameSize;
+	public:
+		TrajectoryReader(std::string const filename);
+		~TrajectoryReader();
+		TrajectoryReader(TrajectoryReader const&) = delete;
+		TrajectoryReader& operator=(TrajectoryReader const&) = delete;
+
+		class iterator {
+			private:
+				TrajectoryReader const* reader;
+				int i;
+			public:
+				iterator(TrajectoryReader const* reader, int const i): reader(reader), i(i){};
+				TrajectoryFrame operator*() const { return reader->frame(i); }
+				iterator& operator++() { i++; return *this; }
+				bool operator!=(iterator const& other) const { return i != other.i; }
+		};
+
+		int size() const;
+		int getN() const;
+		int getD() const;
+		int getProblem() const;
+		std::string getConfig() const;
+		TrajectoryFrame frame(int const i) const;
+		iterator begin() const;
+		iterator end() const;
+};
@@ -3,6 +3,7 @@
 #include <functional>
 #include <algorithm>
 #include <iostream>
+#include <cmath>
 #include "rng.h"
 #include "particle.h"
 
@@ -14,7 +15,7 @@ bool comparePtrs(Solution const* const a, Solution const* const b);
 double distance(Solution const*const s1, Solution const*const s2);
 std::string generateConfig(std::string const templateFile, std::string const name);
 void printVec(std::vector<double> const v);
-std::string checkFilename(std::string fn);
+std::string checkFilename(std::string fn, std::string const sinkType = "F"); // Only the file sink needs a fresh name
 
 template <typename T>
 void sortOnFitness(std::vector<T*>& genomes){
@@ -45,6 +46,25 @@ T* getBest(std::vector<T*>const& genomes){
 	return best;
 }
 
+template<typename T>
+double diversity(std::vector<T*>const& genomes){ // Mean distance to the centroid
+	int const D = genomes[0]->D;
+	std::vector<double> centroid(D, 0.);
+	for (T* s : genomes)
+		for (int j = 0; j < D; j++)
+			centroid[j] += s->getX(j);
+	scale(centroid, 1./genomes.size());
+
+	double sum = 0.;
+	for (T* s : genomes){
+		double d = 0.;
+		for (int j = 0; j < D; j++)
+			d += (s->getX(j) - centroid[j]) * (s->getX(j) - centroid[j]);
+		sum += std::sqrt(d);
+	}
+	return sum / genomes.size();
+}
+
 template<typename T>
 T* getWorst(std::vector<T*>const& genomes){
 	T* worst = NULL;
@@ -0,0 +1,23 @@
+#include "runarchive.h"
+#include <iostream>
+#include <experimental/filesystem>
+
+// Converts legacy scratch/extra_data/<id>.dat files into one run archive.
+// Usage: pso-de-archive <archive> <file.dat>...
+int main(int argc, char** argv){
+	if (argc < 3){
+		std::cerr << "Usage: " << argv[0] << " <archive> <file.dat>..." << std::endl;
+		return 1;
+	}
+
+	RunArchiveWriter archive(argv[1]);
+	int rows = 0;
+	for (int i = 2; i < argc; i++){
+		std::string const config = std::experimental::filesystem::path(argv[i]).stem().string();
+		rows += archive.importLegacy(argv[i], config);
+	}
+	archive.close();
+
+	std::cerr << "Archived " << rows << " runs of " << argc - 2 << " configurations in " << argv[1] << std::endl;
+	return 0;
+}
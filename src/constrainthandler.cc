@@ -5,21 +5,55 @@
 
 bool ConstraintHandler::isFeasible(Solution const * const p) const{
 	for (int i = 0; i < D; i++){
-		if (p->getX(i) < lb[i] - 1.0e-12 || p->getX(i) > ub[i] + 1.0e-12){
+		if (!isFeasible(i, p->x[i])){
 			return false;
 		}
 	}
 	return true;
 }
 
+double* ConstraintHandler::position(Solution* const p){
+	return p->x.data();
+}
+
 bool ConstraintHandler::resample(Solution * const p, int const resamples){
 	return false;
 }
 
+void ConstraintHandler::countResamples(int const resamples){
+	if ((int)resampleHistogram.size() <= resamples)
+		resampleHistogram.resize(resamples + 1, 0);
+	resampleHistogram[resamples]++;
+}
+
 int ConstraintHandler::getCorrections() const {
 	return nCorrected;
 }
 
+std::vector<int> const& ConstraintHandler::getResampleHistogram() const {
+	return resampleHistogram;
+}
+
+void ConstraintHandler::restoreCounts(int const corrections, std::vector<int> const& resampleHistogram){
+	nCorrected = corrections;
+	this->resampleHistogram = resampleHistogram;
+}
+
+void DEConstraintHandler::repairDEAll(std::vector<Solution*> const& p, std::vector<Solution const*> const& bases, std::vector<Solution*> const& targets){
+	for (unsigned int k = 0; k < p.size(); k++)
+		repairDE(p[k], bases[k], targets[k]);
+}
+
+void DEConstraintHandler::repairAll(std::vector<Solution*> const& p){
+	for (Solution* const s : p)
+		repair(s);
+}
+
+void PSOConstraintHandler::repairAll(std::vector<Particle*> const& p){
+	for (Particle* const q : p)
+		repair(q);
+}
+
 std::map<std::string, std::function<DEConstraintHandler*(std::vector<double>, std::vector<double>)>> const deCHs ({
 	// Generic
 	{"DP", LC(DeathPenalty)},
@@ -14,6 +14,10 @@
 #include "util.h"
 #include "repairhandler.h"
 #include "logger.h"
+#include "snapshottrigger.h"
+#include "runarchive.h"
+#include "livefeed.h"
+#include "surrogate.h"
 
 DifferentialEvolution::DifferentialEvolution(DEConfig const config)
 	: config(config){
@@ -27,12 +31,17 @@ void DifferentialEvolution::run(std::shared_ptr<IOHprofiler_problem<double> > co
 	std::vector<double> const lowerBound = problem->IOHprofiler_get_lowerbound();
 	std::vector<double> const upperBound = problem->IOHprofiler_get_upperbound();
 
+	EvaluationBuffer evaluations(problem, logSettings.csv ? iohLogger : nullptr, logSettings.aggregator, evalBudget, evaluationSettings);
 	std::vector<Solution*> genomes(popSize);
 
+	Surrogate* const surrogate = evaluationSettings.surrogate.empty() ? NULL : surrogates.at(evaluationSettings.surrogate)(D);
+
 	for (int i = 0; i < popSize; i++){
 		genomes[i] = new Solution(D);
 		genomes[i]->randomize(lowerBound, upperBound);
-		genomes[i]->evaluate(problem, iohLogger);
+		genomes[i]->evaluate(evaluations);
+		if (surrogate != NULL)
+			surrogate->add(genomes[i]->getX(), genomes[i]->getFitness());
 	}
 
 	DEConstraintHandler * const deCH = deCHs.at(config.constraintHandler)(lowerBound, upperBound);
@@ -44,8 +53,10 @@ void DifferentialEvolution::run(std::shared_ptr<IOHprofiler_problem<double> > co
 	std::vector<double> Crs(popSize);
 	std::vector<double> percCorrected; 
 
-	Logger logger("scratch/extra_data/" + getIdString() + ".dat");
-	Logger loggerParams("scratch/extra_data/" + getIdString() + ".par");
+	Logger logger("scratch/extra_data/" + getIdString() + ".dat", logSettings.sink);
+	Logger loggerParams("scratch/extra_data/" + getIdString() + ".par", logSettings.sink);
+	SnapshotTrigger* const parameterTrigger = createSnapshotTrigger(logSettings.parameterTrigger);
+	LiveFeedWriter liveFeed(logSettings.liveFeed, popSize, D, problem->IOHprofiler_get_problem_id());
 	//Logger loggerAnimation("scratch/animations/" + getIdString() + "_f" +
 			//std::to_string(problem->IOHprofiler_get_problem_id()) + "D" + std::to_string(D) + 
 			//".log");
@@ -53,32 +64,71 @@ void DifferentialEvolution::run(std::shared_ptr<IOHprofiler_problem<double> > co
 	loggerParams.start(problem->IOHprofiler_get_problem_id(), D);
 
 	int iteration = 0;
-	while (problem->IOHprofiler_get_evaluations() < evalBudget && !problem->IOHprofiler_hit_optimal()){
+	int loggedEval = 0;
+	while (evaluations.getSpent() < evalBudget && !problem->IOHprofiler_hit_optimal()){
 		adaptationManager->nextF(Fs);
 		adaptationManager->nextCr(Crs);
 
-		if (iteration % 10 == 0)
+		if (parameterTrigger->fire(iteration, evaluations.getSpent(), evalBudget, genomes))
 			loggerParams.log(Fs, Crs);
 		
 		std::vector<Solution*> const donors = mutationManager->mutate(genomes,Fs);
-		std::vector<Solution*> const trials = crossoverManager->crossover(genomes, donors, Crs);
+		std::vector<Solution*> trials = crossoverManager->crossover(genomes, donors, Crs);
 
 		for (Solution* m : donors)
 			delete m;
 
+		// More rounds of trials with the same F and Cr, the surrogate picks one per target
+		if (surrogate != NULL && surrogate->ready() && evaluationSettings.trialsPerTarget > 1){
+			std::vector<Solution*> candidates = trials;
+			int const corrections = deCH->getCorrections();
+			std::vector<int> const resamples = deCH->getResampleHistogram();
+			for (int k = 1; k < evaluationSettings.trialsPerTarget; k++){
+				std::vector<Solution*> const moreDonors = mutationManager->mutate(genomes, Fs);
+				std::vector<Solution*> const more = crossoverManager->crossover(genomes, moreDonors, Crs);
+				for (Solution* m : moreDonors)
+					delete m;
+				candidates.insert(candidates.end(), more.begin(), more.end());
+			}
+			deCH->restoreCounts(corrections, resamples); // Only the first round counts, as there is one trial per target without the surrogate
+
+			std::vector<double> predicted;
+			surrogate->predict(candidates, predicted, evaluationSettings.threads);
+			std::vector<bool> picked(candidates.size(), false);
+			for (int i = 0; i < popSize; i++){
+				int best = i;
+				for (int c = i + popSize; c < (int)candidates.size(); c += popSize)
+					if (predicted[c] < predicted[best])
+						best = c;
+				trials[i] = candidates[best];
+				picked[best] = true;
+			}
+			for (unsigned int c = 0; c < candidates.size(); c++)
+				if (!picked[c])
+					delete candidates[c];
+		}
+
 		std::vector<double> parentF(popSize), trialF(popSize);
 		for (int i = 0; i < popSize; i++){
 			parentF[i] = genomes[i]->getFitness();
 
-			trials[i]->evaluate(problem, iohLogger);
-
-			deCH->penalize(trials[i]); // This is done after and not before the evaluation, because otherwise it could loop endlessly
+			// Free screens are capped at the budget, so a run stuck outside the bounds still ends
+			if (evaluationSettings.screen && deCH->screen(trials[i]))
+				evaluations.screen(evaluationSettings.budget == "C" || evaluations.getScreened() >= evalBudget);
+			else {
+				trials[i]->evaluate(evaluations);
+				deCH->penalize(trials[i]); // This is done after and not before the evaluation, because otherwise it could loop endlessly
+			}
 
 			trialF[i] = trials[i]->getFitness();
+			if (surrogate != NULL && trialF[i] != std::numeric_limits<double>::max()) // Penalties say nothing about the objective
+				surrogate->add(trials[i]->getX(), trialF[i]);
 
 			int const numEval = problem->IOHprofiler_get_evaluations();
-			if (numEval != 0 && numEval % 100000 == 0)
+			if (numEval != 0 && numEval % 100000 == 0 && numEval != loggedEval){ // Screens and cache hits leave numEval as it is
 				percCorrected.push_back(double(deCH->getCorrections()) / numEval);
+				loggedEval = numEval;
+			}
 
 			if (trialF[i] < parentF[i])
 				genomes[i]->setX(trials[i]->getX(), trialF[i]);
@@ -90,6 +140,8 @@ void DifferentialEvolution::run(std::shared_ptr<IOHprofiler_problem<double> > co
 		//loggerAnimation.log(genomes);
 
 		adaptationManager->update(parentF, trialF);
+		evaluations.flush();
+		liveFeed.publish(genomes);
 		iteration++;
 	}
 
@@ -106,6 +158,9 @@ void DifferentialEvolution::run(std::shared_ptr<IOHprofiler_problem<double> > co
 
 	logger.log(problem->IOHprofiler_get_problem_id(), D, percCorrected, best->getX(), best->getFitness(), problem->IOHprofiler_get_evaluations());
 	loggerParams.newLine();
+	if (logSettings.archive != NULL)
+		logSettings.archive->add(RunRecord{getIdString(), problem->IOHprofiler_get_problem_id(), D, percCorrected, 
+			best->getX(), best->getFitness(), problem->IOHprofiler_get_evaluations()});
 
 	for (Solution* d : genomes)
 		delete d;
@@ -113,11 +168,23 @@ void DifferentialEvolution::run(std::shared_ptr<IOHprofiler_problem<double> > co
 	delete mutationManager;
 	delete crossoverManager;
 	delete adaptationManager;
+	if (evaluationSettings.counters != NULL)
+		evaluationSettings.counters->addResamples(deCH->getResampleHistogram());
 	delete deCH;
+	delete parameterTrigger;
+	delete surrogate;
 
 	genomes.clear();
 }
 
+void DifferentialEvolution::setLogSettings(LogSettings const logSettings){
+	this->logSettings = logSettings;
+}
+
+void DifferentialEvolution::setEvaluationSettings(EvaluationSettings const evaluationSettings){
+	this->evaluationSettings = evaluationSettings;
+}
+
 std::string DifferentialEvolution::getIdString() const {
 	return /*"DE_" +*/ config.mutation + "_" + config.crossover + "_" /*+ config.adaptation + "_"*/ + config.constraintHandler;
 }
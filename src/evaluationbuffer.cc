@@ -0,0 +1,185 @@
+#include <IOHprofiler_problem.h>
+#include <IOHprofiler_csv_logger.h>
+#include "evaluationbuffer.h"
+#include "performanceaggregator.h"
+#include <cstring>
+#include <cstdint>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+
+EvaluationBuffer::EvaluationBuffer(std::shared_ptr<IOHprofiler_problem<double> > const problem,
+		std::shared_ptr<IOHprofiler_csv_logger> const logger, PerformanceAggregator* const aggregator, 
+		int const evalBudget, EvaluationSettings const settings, int const capacity)
+	: problem(problem), logger(logger), aggregator(aggregator), evalBudget(evalBudget), capacity(capacity), recordSize(0), size(0), settings(settings){
+	if (aggregator != NULL)
+		aggregator->startRun(problem->IOHprofiler_get_problem_id(), problem->IOHprofiler_get_number_of_variables(),
+			problem->IOHprofiler_get_optimal()[0], evalBudget);
+}
+
+EvaluationBuffer::~EvaluationBuffer(){
+	flush();
+	if (aggregator != NULL)
+		aggregator->endRun(getSpent());
+	if (settings.counters != NULL){
+		settings.counters->screened += counters.screened;
+		settings.counters->charged += counters.charged;
+		settings.counters->hits += counters.hits;
+		settings.counters->misses += counters.misses;
+		settings.counters->spent += getSpent();
+	}
+}
+
+std::size_t EvaluationBuffer::BitHash::operator()(std::vector<double> const* const x) const {
+	uint64_t h = x->size();
+	for (double const v : *x){
+		uint64_t bits;
+		std::memcpy(&bits, &v, sizeof(bits));
+		h ^= bits + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+	}
+	return h;
+}
+
+bool EvaluationBuffer::BitEqual::operator()(std::vector<double> const* const a, std::vector<double> const* const b) const {
+	return a->size() == b->size() && std::memcmp(a->data(), b->data(), a->size() * sizeof(double)) == 0;
+}
+
+// A hit never reaches the problem, it is only logged when it is charged. Once
+// there were as many free hits as the budget, hits are charged, otherwise a
+// population that keeps proposing cached points would never use up the budget.
+double EvaluationBuffer::evaluate(std::vector<double> const& x){
+	std::lock_guard<std::mutex> lock(mutex);
+	if (settings.cacheSize <= 0)
+		return evaluateLocked(x);
+
+	auto const hit = cached.find(&x);
+	if (hit != cached.end()){
+		counters.hits++;
+		if (settings.cacheBudget == "C" || counters.hits > evalBudget)
+			chargeLocked();
+		cache.splice(cache.begin(), cache, hit->second);
+		return hit->second->fitness;
+	}
+
+	counters.misses++;
+	double const fitness = evaluateLocked(x);
+	if ((int)cache.size() == settings.cacheSize){ // The least recently used entry makes room
+		cached.erase(&cache.back().x);
+		cache.pop_back();
+	}
+	cache.push_front(Cached{x, fitness});
+	cached.emplace(&cache.front().x, cache.begin());
+	return fitness;
+}
+
+// The record comes from the problem, which knows its own transformation and
+// optimization direction; only the evaluation count is replaced
+double EvaluationBuffer::evaluateLocked(std::vector<double> const& x){
+	double const fitness = problem->evaluate(x);
+	std::vector<double> const record = problem->loggerCOCOInfo();
+	if (recordSize == 0){ // Records have a fixed size, so the buffer is allocated once
+		recordSize = record.size();
+		records.resize(capacity * recordSize);
+		info.resize(recordSize);
+	}
+
+	double* const row = records.data() + size * recordSize;
+	std::copy(record.begin(), record.end(), row);
+	row[0] = getSpent();
+	size++;
+
+	if (size == capacity)
+		flushLocked();
+	return fitness;
+}
+
+// Repeats the last record with the new spent count
+void EvaluationBuffer::chargeLocked(){
+	counters.charged++;
+	if (recordSize == 0) // Nothing was evaluated yet
+		return;
+
+	double* const row = records.data() + size * recordSize;
+	double const* const last = size > 0 ? row - recordSize : info.data();
+	std::copy(last, last + recordSize, row);
+	row[0] = getSpent();
+	size++;
+
+	if (size == capacity)
+		flushLocked();
+}
+
+void EvaluationBuffer::flush(){
+	std::lock_guard<std::mutex> lock(mutex);
+	flushLocked();
+}
+
+void EvaluationBuffer::flushLocked(){
+	for (int i = 0; i < size; i++){
+		std::copy(records.begin() + i * recordSize, records.begin() + (i+1) * recordSize, info.begin());
+		if (logger != NULL)
+			logger->do_log(info);
+		if (aggregator != NULL)
+			aggregator->observe(info[0], info[2]); // Evaluations and best-so-far raw objective
+	}
+	size = 0;
+}
+
+void EvaluationBuffer::screen(bool const charge){
+	std::lock_guard<std::mutex> lock(mutex);
+	counters.screened++;
+	if (charge)
+		chargeLocked();
+}
+
+int EvaluationBuffer::getScreened() const {
+	return counters.screened;
+}
+
+int EvaluationBuffer::getSpent() const {
+	return problem->IOHprofiler_get_evaluations() + counters.charged;
+}
+
+EvaluationCounters const& EvaluationBuffer::getCounters() const {
+	return counters;
+}
+
+/*		Counters 		*/
+void EvaluationCounters::save(std::string const filename) const {
+	std::ofstream file(filename + ".tmp", std::ios::trunc);
+	file << "# screened charged hits misses spent\n"
+		<< screened << " " << charged << " " << hits << " " << misses << " " << spent << "\n"
+		<< "# candidates accepted after 0, 1, ... resamples\n";
+	for (unsigned int k = 0; k < resamples.size(); k++)
+		file << (k > 0 ? " " : "") << resamples[k];
+	file << "\n";
+	file.close();
+	if (!file || std::rename((filename + ".tmp").c_str(), filename.c_str()) != 0)
+		std::cerr << "Cannot write " << filename << std::endl;
+}
+
+void EvaluationCounters::load(std::string const filename){
+	std::ifstream in(filename);
+	std::string comment, counts, histogram;
+	if (!std::getline(in, comment) || !std::getline(in, counts) || !std::getline(in, comment) || !std::getline(in, histogram))
+		return;
+
+	std::istringstream values(counts);
+	int s, c, h, m, e;
+	if (!(values >> s >> c >> h >> m >> e)){
+		std::cerr << "Ignoring " << filename << ", it has no spent count" << std::endl;
+		return;
+	}
+	screened += s;
+	charged += c;
+	hits += h;
+	misses += m;
+	spent += e;
+
+	std::istringstream counted(histogram);
+	std::vector<int> earlier;
+	for (int k; counted >> k;)
+		earlier.push_back(k);
+	addResamples(earlier);
+}
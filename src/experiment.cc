@@ -1,26 +1,38 @@
 #include <IOHprofiler_experimenter.h>
 #include <random>
 #include <set>
+#include <experimental/filesystem>
 #include "desuite.h"
 #include "hybridalgorithm.h"
 #include "differentialevolution.h"
 #include "hybridsuite.h"
 #include "psode2.h"
 #include "util.h"
+#include "sweepmanifest.h"
+#include "runarchive.h"
 
 HybridAlgorithm* ha;
 ParticleSwarm* pso;
 DifferentialEvolution* de;
 PSODE2* psode2;
+SweepManifest* manifest;
+EvaluationCounters counters;
+RunArchiveWriter* archive;
 
 void algorithm
 (std::shared_ptr<IOHprofiler_problem<double>> problem,
  std::shared_ptr<IOHprofiler_csv_logger> logger) {
     int const D = problem->IOHprofiler_get_number_of_variables(); 
+    WorkUnit const unit = manifest->next(de->getIdString(), problem->IOHprofiler_get_problem_id(),
+            problem->IOHprofiler_get_instance_id(), D);
+    rng.seed(unit.rngSeed());
+    int const spent = counters.spent;
     //psode2->run(problem, logger, D*10000, D*5, std::map<int,double>()); 
     //psode->run(problem, logger, D*10000, D*5, std::map<int,double>()); 
     //pso->run(problem, logger, D*10000, D*5, std::map<int,double>()); 
     de->run(problem, logger, D*10000, 5 * D); 
+    manifest->complete(unit, counters.spent - spent, problem->loggerCOCOInfo()[2]);
+    counters.save("scratch/summary/" + de->getIdString() + ".counters"); // Holds every run so far
 }
 
 void _run_experiment(bool const log) {
@@ -33,12 +45,30 @@ void _run_experiment(bool const log) {
     //pso = new ParticleSwarm(PSOConfig("I", "M", "PR", "A"));
 
     de = new DifferentialEvolution(DEConfig("P1", "B", "S", "PM"));
+    EvaluationSettings evaluationSettings;
+    evaluationSettings.counters = &counters;
+    //evaluationSettings.cacheSize = 1000;
+    //evaluationSettings.surrogate = "K";
+    de->setEvaluationSettings(evaluationSettings);
+    std::experimental::filesystem::create_directories("scratch/summary");
+    counters.load("scratch/summary/" + de->getIdString() + ".counters");
+    std::experimental::filesystem::create_directories("scratch/archive");
+    archive = new RunArchiveWriter("scratch/archive/" + de->getIdString() + ".arc", true);
+    LogSettings logSettings;
+    logSettings.archive = archive;
+    de->setLogSettings(logSettings);
 	std::string templateFile = "./configuration.ini";
-    std::string configFile = generateConfig(templateFile, de->getIdString());
-    IOHprofiler_experimenter<double> experimenter(configFile,algorithm); 
+    manifest = new SweepManifest("scratch/manifest/" + de->getIdString() + ".manifest");
+    for (SweepBatch const& batch : manifest->pending(templateFile, de->getIdString(), 5)){
+        IOHprofiler_experimenter<double> experimenter(batch.configFile,algorithm); 
 
-    experimenter._set_independent_runs(5);
-    experimenter._run();
+        experimenter._set_independent_runs(batch.runs);
+        experimenter._run();
+    }
+    archive->close();
+
+    delete archive;
+    delete manifest;
     delete de;
     //delete de;
 	//delete psode;
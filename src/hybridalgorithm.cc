@@ -4,3 +4,11 @@ HybridAlgorithm::HybridAlgorithm(HybridConfig const config)
 		: config(config){}
 
 HybridAlgorithm::~HybridAlgorithm(){}
+
+void HybridAlgorithm::setLogSettings(LogSettings const logSettings){
+	this->logSettings = logSettings;
+}
+
+void HybridAlgorithm::setEvaluationSettings(EvaluationSettings const evaluationSettings){
+	this->evaluationSettings = evaluationSettings;
+}
@@ -0,0 +1,189 @@
+#include "livefeed.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Layout: the header padded to a cache line, then `slots` slots holding an
+// 8 byte sequence number followed by one frame. The sequence number of frame
+// k is 2k+1 while it is written and 2k+2 once it is complete.
+constexpr std::size_t HEADER_SIZE = 64;
+
+static std::size_t slotSize(int const N, int const D){
+	return 8 + (((std::size_t(N) * D + N) * sizeof(float) + 7) & ~std::size_t(7));
+}
+
+static std::string shmName(std::string const name){
+	return name[0] == '/' ? name : "/" + name;
+}
+
+static std::atomic<uint64_t>* sequence(char* const data, std::size_t const size, int const slots, uint64_t const k){
+	return reinterpret_cast<std::atomic<uint64_t>*>(data + HEADER_SIZE + (k % slots) * size);
+}
+
+/*		Writer 		*/
+LiveFeedWriter::LiveFeedWriter(std::string const name, int const N, int const D, int const problem, int const slots)
+	: name(name.empty() ? name : shmName(name)), N(N), D(D), slots(slots),
+	length(HEADER_SIZE + slots * slotSize(N, D)), data(NULL), header(NULL){
+
+	if (name.empty())
+		return;
+
+	shm_unlink(this->name.c_str()); // Left behind by a run that did not finish
+	int const fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0)
+		throw std::runtime_error("Cannot create live feed " + name);
+	if (ftruncate(fd, length) != 0){
+		close(fd);
+		throw std::runtime_error("Cannot size live feed " + name);
+	}
+	void* const mapped = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED)
+		throw std::runtime_error("Cannot map live feed " + name);
+	data = static_cast<char*>(mapped);
+
+	header = new (data) LiveFeedHeader;
+	header->version = LIVEFEED_VERSION;
+	header->N = N;
+	header->D = D;
+	header->slots = slots;
+	header->problem = problem;
+	header->closed.store(0);
+	header->published.store(0);
+	for (int k = 0; k < slots; k++)
+		new (sequence(data, slotSize(N, D), slots, k)) std::atomic<uint64_t>(0);
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(header->magic, LIVEFEED_MAGIC, sizeof(header->magic)); // Last, so readers never see a partial header
+}
+
+LiveFeedWriter::~LiveFeedWriter(){
+	if (data == NULL)
+		return;
+	shm_unlink(name.c_str()); // First, so readers that see closed attach to the next feed
+	header->closed.store(1, std::memory_order_release);
+	munmap(data, length);
+}
+
+bool LiveFeedWriter::enabled() const {
+	return data != NULL;
+}
+
+float* LiveFeedWriter::begin(){
+	uint64_t const k = header->published.load(std::memory_order_relaxed);
+	std::atomic<uint64_t>* const seq = sequence(data, slotSize(N, D), slots, k);
+	seq->store(2 * k + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	return reinterpret_cast<float*>(seq + 1);
+}
+
+void LiveFeedWriter::commit(){
+	uint64_t const k = header->published.load(std::memory_order_relaxed);
+	sequence(data, slotSize(N, D), slots, k)->store(2 * k + 2, std::memory_order_release);
+	header->published.store(k + 1, std::memory_order_release);
+}
+
+/*		Reader 		*/
+LiveFeedReader::LiveFeedReader(std::string const name)
+	: name(shmName(name)), length(0), data(NULL), header(NULL), next(0), lost(0){
+	attach();
+}
+
+LiveFeedReader::~LiveFeedReader(){
+	detach();
+}
+
+void LiveFeedReader::detach(){
+	if (data != NULL)
+		munmap(data, length);
+	data = NULL;
+	header = NULL;
+}
+
+bool LiveFeedReader::attach(){
+	detach();
+	int const fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (std::size_t)st.st_size < HEADER_SIZE){
+		close(fd);
+		return false;
+	}
+	length = st.st_size;
+	void* const mapped = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED)
+		return false;
+	data = static_cast<char*>(mapped);
+	header = reinterpret_cast<LiveFeedHeader const*>(data);
+
+	if (std::memcmp(header->magic, LIVEFEED_MAGIC, sizeof(header->magic)) != 0 || header->version != LIVEFEED_VERSION
+			|| header->slots == 0 || length < HEADER_SIZE + header->slots * slotSize(header->N, header->D)){
+		detach();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	next = header->published.load(std::memory_order_acquire); // Start at the live end
+	lost = 0;
+	return true;
+}
+
+bool LiveFeedReader::attached() const {
+	return header != NULL;
+}
+
+bool LiveFeedReader::closed() const {
+	return header == NULL || header->closed.load(std::memory_order_acquire) != 0;
+}
+
+int LiveFeedReader::getN() const {
+	return header == NULL ? 0 : header->N;
+}
+
+int LiveFeedReader::getD() const {
+	return header == NULL ? 0 : header->D;
+}
+
+int LiveFeedReader::getProblem() const {
+	return header == NULL ? 0 : header->problem;
+}
+
+bool LiveFeedReader::read(std::vector<float>& frame, bool const latest){
+	if (header == NULL)
+		return false;
+	int const N = header->N, D = header->D, slots = header->slots;
+	std::size_t const size = slotSize(N, D);
+	frame.resize(std::size_t(N) * D + N);
+
+	for (int attempt = 0; attempt < 4; attempt++){
+		uint64_t const published = header->published.load(std::memory_order_acquire);
+		if (next >= published)
+			return false;
+		// The slot after the newest frame may already be overwritten
+		uint64_t const oldest = published >= uint64_t(slots) ? published - slots + 1 : 0;
+		uint64_t const k = latest ? published - 1 : std::max(next, oldest);
+
+		std::atomic<uint64_t> const* const seq = sequence(data, size, slots, k);
+		uint64_t const before = seq->load(std::memory_order_acquire);
+		if (before != 2 * k + 2)
+			continue;
+		std::memcpy(frame.data(), seq + 1, frame.size() * sizeof(float));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (seq->load(std::memory_order_relaxed) != before)
+			continue;
+
+		lost += k - next;
+		next = k + 1;
+		return true;
+	}
+	return false;
+}
+
+uint64_t LiveFeedReader::dropped() const {
+	return lost;
+}
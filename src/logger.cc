@@ -4,6 +4,8 @@
 
 void Logger::log(int const function, int const D, std::vector<double> const percCorrected, 
 		std::vector<double> const bestX, double const bestF, int const numEvals){
+	if (!sink->enabled())
+		return;
 	out.precision(3);
 
 	out << function << " " << D << " ";
@@ -12,23 +14,35 @@ void Logger::log(int const function, int const D, std::vector<double> const perc
 	for (double d : bestX)
 		out << d << " ";
 	out << bestF << " " << numEvals << "\n";
+	commit();
 }
 
 void Logger::start(int const function, int const D){
+	if (!sink->enabled())
+		return;
 	out << function << " " << D << ":";
+	commit();
 }
 
 void Logger::log(std::vector<double> F, std::vector<double> Cr){
+	if (!sink->enabled())
+		return;
 	out.precision(3);
 	double const avgF = std::accumulate(F.begin(), F.end(), 0.) / double(F.size());
 	double const avgCr = std::accumulate(Cr.begin(), Cr.end(), 0.) / double(Cr.size());
 	out << avgF << " " << avgCr << ","; 
+	commit();
 }
 
 void Logger::newLine(){
-	out << "\n";
+	sink->write("\n", 1);
+}
+
+void Logger::commit(){
+	sink->write(out.str());
+	out.str("");
 }
 
 Logger::~Logger(){
-	out.close();
+	delete sink;
 };
@@ -0,0 +1,64 @@
+#include "logsink.h"
+#include <iostream>
+
+#define LC(X) [](std::string const name, bool const append){return new X(name, append);}
+std::map<std::string, std::function<LogSink* (std::string const, bool const)>> const logSinks({
+		{"F", LC(FileSink)},
+		{"M", LC(MemorySink)},
+		{"N", LC(NullSink)},
+});
+
+/*		File 		*/
+FileSink::~FileSink(){
+	if (out.is_open() && !failed){
+		out.close(); // Buffered data can still fail here
+		if (out.fail())
+			fail("write");
+	}
+}
+
+void FileSink::fail(std::string const what){
+	std::cerr << "Cannot " << what << " " << filename << std::endl;
+	failed = true;
+}
+
+void FileSink::write(char const* data, std::size_t const size){
+	if (failed)
+		return;
+	if (!out.is_open()){ // Opened on first use, so unused logs cost no I/O
+		out.open(filename, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+		if (!out.is_open()){
+			fail("open");
+			return;
+		}
+	}
+	out.write(data, size);
+	if (!out)
+		fail("write");
+}
+
+/*		Memory 		*/
+std::map<std::string, std::string> MemorySink::store;
+std::mutex MemorySink::mutex;
+
+MemorySink::MemorySink(std::string const name, bool const append): name(name){
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!append)
+		store[name].clear();
+}
+
+void MemorySink::write(char const* data, std::size_t const size){
+	std::lock_guard<std::mutex> lock(mutex);
+	store[name].append(data, size);
+}
+
+std::string MemorySink::contents(std::string const name){
+	std::lock_guard<std::mutex> lock(mutex);
+	auto const it = store.find(name);
+	return it == store.end() ? "" : it->second;
+}
+
+void MemorySink::clear(){
+	std::lock_guard<std::mutex> lock(mutex);
+	store.clear();
+}
@@ -3,14 +3,22 @@
 #include <set>
 #include <mpi.h>
 #include <fstream>
+#include <experimental/filesystem>
 #include "hybridalgorithm.h"
 #include "differentialevolution.h"
 #include "desuite.h"
 #include "hybridsuite.h"
 #include "particleswarmsuite.h"
 #include "util.h"
+#include "performanceaggregator.h"
+#include "sweepmanifest.h"
+#include "runarchive.h"
 
 DESuite suite;
+PerformanceAggregator* aggregator;
+EvaluationCounters counters;
+SweepManifest* manifest;
+RunArchiveWriter* archive;
 
 void experiment
 	(std::shared_ptr<IOHprofiler_problem<double>> problem,
@@ -22,8 +30,29 @@ void experiment
 	int id;
 	MPI_Comm_rank(MPI_COMM_WORLD, &id);
 
+	LogSettings settings;
+	settings.aggregator = aggregator;
+	settings.archive = archive;
+	//settings.csv = false; // Only keep the ERT/ECDF summary
+
+	EvaluationSettings evaluationSettings;
+	evaluationSettings.counters = &counters;
+	//evaluationSettings.screen = true; // Let a death penalty reject candidates before they are evaluated
+	//evaluationSettings.cacheSize = 1000;
+	//evaluationSettings.surrogate = "K";
+
 	DifferentialEvolution de = suite.getDE(id);
+	WorkUnit const unit = manifest->next(de.getIdString(), problem->IOHprofiler_get_problem_id(),
+			problem->IOHprofiler_get_instance_id(), D);
+
+	rng.seed(unit.rngSeed());
+	int const spent = counters.spent;
+	de.setLogSettings(settings);
+	de.setEvaluationSettings(evaluationSettings);
   	de.run(problem, logger, D*10000, popSize);
+	manifest->complete(unit, counters.spent - spent, problem->loggerCOCOInfo()[2]);
+	aggregator->save("scratch/summary/" + de.getIdString() + ".ert.sums"); // A crash loses at most this run from the summary
+	counters.save("scratch/summary/" + de.getIdString() + ".counters");
 }
 
 int main(int argc, char **argv) {
@@ -38,10 +67,31 @@ int main(int argc, char **argv) {
 	MPI_Comm_rank(MPI_COMM_WORLD, &id);
 
 	if (id < suite.size()){
-		std::string configFile = generateConfig(templateFile, suite.getDE(id).getIdString());
-		IOHprofiler_experimenter<double> experimenter(configFile, experiment);
-		experimenter._set_independent_runs(100);
-		experimenter._run();
+		std::experimental::filesystem::create_directories("scratch/summary");
+		aggregator = new PerformanceAggregator(suite.getDE(id).getIdString());
+		aggregator->load("scratch/summary/" + suite.getDE(id).getIdString() + ".ert.sums");
+		counters.load("scratch/summary/" + suite.getDE(id).getIdString() + ".counters");
+		manifest = new SweepManifest("scratch/manifest/" + suite.getDE(id).getIdString() + ".manifest");
+		std::experimental::filesystem::create_directories("scratch/archive");
+		archive = new RunArchiveWriter("scratch/archive/" + suite.getDE(id).getIdString() + ".arc", true); // One per configuration, as ranks do not share files
+		if (manifest->size() > 0)
+			std::cerr << suite.getDE(id).getIdString() << ": resuming, " << manifest->size() << " runs already done" << std::endl;
+		std::vector<SweepBatch> const batches = manifest->pending(templateFile, suite.getDE(id).getIdString(), 100);
+		for (SweepBatch const& batch : batches){
+			IOHprofiler_experimenter<double> experimenter(batch.configFile, experiment);
+			experimenter._set_independent_runs(batch.runs);
+			experimenter._run();
+		}
+		archive->close();
+
+		if (!batches.empty()){ // Holds every run so far, a sweep that was already done leaves it as it is
+			LogSink* const summary = logSinks.at("F")("scratch/summary/" + suite.getDE(id).getIdString() + ".ert", false);
+			aggregator->write(summary);
+			delete summary;
+		}
+		delete aggregator;
+		delete archive;
+		delete manifest;
 	} else {
 		std::cerr << "Error: suite does not contain " << id << std::endl;
 	}
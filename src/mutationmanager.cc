@@ -1,5 +1,6 @@
 #include "mutationmanager.h"
 #include "util.h"
+#include <algorithm>
 #include <limits>
 #include <numeric>
 
@@ -12,23 +13,66 @@ std::vector<Solution*> MutationManager::mutate(std::vector<Solution*>const& geno
 	preMutation(); // Some mutation managers use this to prepare some stuff
 
 	std::vector<Solution*> mutants(genomes.size());
+	std::vector<Solution const*> bases(genomes.size());
+	MutationDraw d;
+
+	if (!deCH->canResample()){ // Every mutant is kept, so they are repaired together
+		for (unsigned int i = 0; i < genomes.size(); i++){
+			mutants[i] = new Solution(D);
+			draw(i, d);
+			build(d, position(mutants[i]), 0, D);
+			bases[i] = d.base;
+		}
+		deCH->repairDEAll(mutants, bases, genomes);
+		deCH->repairAll(mutants); //generic repair
+		return mutants;
+	}
 
+	// A rejected mutant only costs its draws and the dimensions up to its first
+	// violation; its row is overwritten by the next candidate
 	for (unsigned int i = 0; i < genomes.size(); i++){
-		int resamples = 0;
-		while (true){
-			Solution* m = mutate(i);
+		Solution* const m = new Solution(D);
+		double* const x = position(m);
+		for (int resamples = 0; ; resamples++){
+			draw(i, d);
+			bool const early = deCH->rejectsInfeasible(resamples);
+			if (early && !buildFeasible(d, x)){
+				deCH->resample(m, resamples);
+				continue;
+			}
+			if (!early)
+				build(d, x, 0, D);
+			deCH->repairDE(m, d.base, genomes[i]);
 			if (!deCH->resample(m, resamples)){
 				deCH->repair(m); //generic repair
-				mutants[i] = m; 
+				mutants[i] = m;
 				break;
 			}
-			resamples++;
-			delete m;
 		}
 	}
 	return mutants;
 }
 
+bool MutationManager::buildFeasible(MutationDraw const& d, double* const x) const{
+	int const block = 16;
+	for (int from = 0; from < D; from += block){
+		int const to = std::min(D, from + block);
+		build(d, x, from, to);
+		for (int j = from; j < to; j++)
+			if (!deCH->isFeasible(j, x[j]))
+				return false;
+	}
+	return true;
+}
+
+double* MutationManager::position(Solution* const s){
+	return s->x.data();
+}
+
+double const* MutationManager::position(Solution const* const s){
+	return s->x.data();
+}
+
 std::map<std::string, std::function<MutationManager* (int const, DEConstraintHandler*const)>> const mutations ({
 		{"R1", LC(Rand1MutationManager)},
 		{"T1", LC(TTB1MutationManager)},
@@ -47,20 +91,20 @@ std::map<std::string, std::function<MutationManager* (int const, DEConstraintHan
 });
 
 // Rand/1
-Solution* Rand1MutationManager::mutate(int const i) const{
+void Rand1MutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
 	std::vector<Solution*> xr = pickRandom(possibilities, 3);
-	std::vector<double> mutant = xr[0]->getX();
-	std::vector<double> difference(D);
-	subtract(xr[1]->getX(), xr[2]->getX(), difference);
-	scale(difference, Fs[i]);
-	add(mutant,difference, mutant);
+	for (int k = 0; k < 3; k++)
+		d.x[k] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = xr[0];
+}
 
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, xr[0], genomes[i]);
-	return m;
+void Rand1MutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[2][j]) * d.F;
 }
 
 // Target-to-best/1
@@ -68,24 +112,22 @@ void TTB1MutationManager::preMutation(){
 	best = getBest(genomes);
 }
 
-Solution* TTB1MutationManager::mutate(int const i) const{
+void TTB1MutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
-	std::vector<double> mutant = genomes[i]->getX();
-	std::vector<double> difference(D);
-
 	std::vector<Solution*> xr = pickRandom(possibilities, 2);
+	d.x[0] = position(genomes[i]);
+	d.x[1] = position(best);
+	for (int k = 0; k < 2; k++)
+		d.x[k + 2] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = genomes[i];
+}
 
-	subtract(best->getX(), genomes[i]->getX(), difference);
-	add(difference, xr[0]->getX(), difference);
-	subtract(difference, xr[1]->getX(), difference);
-	scale(difference,Fs[i]);
-
-	add(mutant, difference, mutant);
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, genomes[i], genomes[i]);
-	return m;
+void TTB1MutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[0][j] + d.x[2][j] - d.x[3][j]) * d.F;
 }
 
 // Target-to-best/2
@@ -93,51 +135,44 @@ void TTB2MutationManager::preMutation(){
 	best = getBest(genomes);
 }
 
-Solution* TTB2MutationManager::mutate(int const i) const{
+void TTB2MutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
-	std::vector<double> mutant = genomes[i]->getX();
-	std::vector<double> difference(D);
-
 	std::vector<Solution*> xr = pickRandom(possibilities, 4);
+	d.x[0] = position(genomes[i]);
+	d.x[1] = position(best);
+	for (int k = 0; k < 4; k++)
+		d.x[k + 2] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = genomes[i];
+}
 
-	subtract(best->getX(), genomes[i]->getX(), difference);
-	add(difference, xr[0]->getX(), difference);
-	subtract(difference, xr[1]->getX(), difference);
-	add(difference, xr[2]->getX(), difference);
-	subtract(difference, xr[3]->getX(), difference);
-	scale(difference,Fs[i]);
-
-	add(mutant, difference, mutant);
-
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, genomes[i], genomes[i]);
-	return m;
+void TTB2MutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[0][j] + d.x[2][j] - d.x[3][j] + d.x[4][j] - d.x[5][j]) * d.F;
 }
 
 // Target-to-pbest/1
-Solution* TTPB1MutationManager::mutate(int const i) const{
+void TTPB1MutationManager::draw(int const i, MutationDraw& d){
 	Solution* pBest = getPBest(genomes); // pBest is sampled for each mutation
 
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
-	std::vector<double> mutant = genomes[i]->getX();
-	std::vector<double> difference(D);
-
 	std::vector<Solution*> xr = pickRandom(possibilities, 2);
+	d.x[0] = position(genomes[i]);
+	d.x[1] = position(pBest);
+	for (int k = 0; k < 2; k++)
+		d.x[k + 2] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = genomes[i];
+}
 
-	subtract(pBest->getX(), genomes[i]->getX(), difference);
-	add(difference, xr[0]->getX(), difference);
-	subtract(difference, xr[1]->getX(), difference);
-	scale(difference,Fs[i]);
-
-	add(mutant, difference, mutant);
-
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, genomes[i], genomes[i]);
-	return m;
+// Same as target-to-best/1
+void TTPB1MutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[0][j] + d.x[2][j] - d.x[3][j]) * d.F;
 }
 
 // Best/1
@@ -145,22 +180,21 @@ void Best1MutationManager::preMutation(){
 	best = getBest(genomes);
 }
 
-Solution* Best1MutationManager::mutate(int const i) const{
+void Best1MutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
-	std::vector<double> mutant = best->getX();
-	std::vector<double> difference(D);
-	
 	std::vector<Solution*> xr = pickRandom(possibilities, 2);
-	subtract(xr[0]->getX(), xr[1]->getX(), difference);
-
-	scale(difference, Fs[i]);
-	add(mutant, difference, mutant);
+	d.x[0] = position(best);
+	for (int k = 0; k < 2; k++)
+		d.x[k + 1] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = best;
+}
 
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, best, genomes[i]);
-	return m;
+void Best1MutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[2][j]) * d.F;
 }
 
 // Best/2
@@ -168,47 +202,42 @@ void Best2MutationManager::preMutation(){
 	best = getBest(genomes);
 }
 
-Solution* Best2MutationManager::mutate(int const i) const{
+void Best2MutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
-	std::vector<double> mutant = best->getX();
-	std::vector<double> difference(D);
-
 	std::vector<Solution*> xr = pickRandom(possibilities, 4);
-	subtract(xr[0]->getX(), xr[1]->getX(), difference);
-	add(difference, xr[2]->getX(), difference);
-	subtract(difference, xr[3]->getX(), difference);
-	scale(difference, Fs[i]);
-	add(mutant, difference, mutant);
+	d.x[0] = position(best);
+	for (int k = 0; k < 4; k++)
+		d.x[k + 1] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = best;
+}
 
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, best, genomes[i]);
-	return m;
+void Best2MutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[2][j] + d.x[3][j] - d.x[4][j]) * d.F;
 }
 
 // Rand/2
-Solution* Rand2MutationManager::mutate(int const i) const{
+void Rand2MutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
 	std::vector<Solution*> xr = pickRandom(possibilities, 5);
-	std::vector<double> mutant = xr[4]->getX();
-	std::vector<double> difference(D);
-
-	subtract(xr[0]->getX(), xr[1]->getX(), difference);
-	add(difference, xr[2]->getX(), difference);
-	subtract(difference, xr[3]->getX(), difference);
-	scale(difference, Fs[i]);
+	for (int k = 0; k < 5; k++)
+		d.x[k] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = xr[4];
+}
 
-	add(mutant, difference, mutant);
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, xr[4], genomes[i]);
-	return m;
+void Rand2MutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[4][j] + (d.x[0][j] - d.x[1][j] + d.x[2][j] - d.x[3][j]) * d.F;
 }
 
 // Rand/2/dir
-Solution* Rand2DirMutationManager::mutate(int const i) const{
+void Rand2DirMutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
@@ -220,110 +249,92 @@ Solution* Rand2DirMutationManager::mutate(int const i) const{
 	if (xr[3]->getFitness() < xr[2]->getFitness())
 		std::swap(xr[2], xr[3]);
 
-	std::vector<double> mutant = xr[0]->getX();
-
-	std::vector<double> difference(D);
-	subtract(xr[0]->getX(), xr[1]->getX(), difference);
-	add(difference, xr[2]->getX(), difference);
-	subtract(difference, xr[3]->getX(), difference);
-	scale(difference, Fs[i]/2.);
-
-	add(mutant, difference, mutant);
+	for (int k = 0; k < 4; k++)
+		d.x[k] = position(xr[k]);
+	d.F = Fs[i]/2.;
+	d.base = xr[0];
+}
 
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, xr[0], genomes[i]);
-	return m;
+void Rand2DirMutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[0][j] - d.x[1][j] + d.x[2][j] - d.x[3][j]) * d.F;
 }
 
 // NSDE
-Solution* NSDEMutationManager::mutate(int const i) const {
+void NSDEMutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
 	std::vector<Solution*> xr = pickRandom(possibilities, 3);
-	std::vector<double> mutant = xr[0]->getX(); 
+	for (int k = 0; k < 3; k++)
+		d.x[k] = position(xr[k]);
 
-	std::vector<double> difference(D);
-	subtract(xr[1]->getX(), xr[2]->getX(), difference);
-
-	double randomVar;
 	if (rng.randDouble(0,1) < 0.5)
-		randomVar = rng.normalDistribution(0.5,0.5);
+		d.F = rng.normalDistribution(0.5,0.5);
 	else 
-		randomVar = rng.cauchyDistribution(0,1);
-
-	scale(difference, randomVar);
-
-	add(mutant, difference, mutant);
+		d.F = rng.cauchyDistribution(0,1);
+	d.base = xr[0];
+}
 
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, xr[0], genomes[i]);
-	return m;
+void NSDEMutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[2][j]) * d.F;
 }
 
 // Trigonometric
-Solution* TrigonometricMutationManager::mutate(int const i) const{
-	return rng.randDouble(0,1) <= gamma ? trigonometricMutation(i) : rand1Mutation(i);
+TrigonometricMutationManager::~TrigonometricMutationManager(){
+	for (Solution* const c : centroids)
+		delete c;
 }
 
-Solution* TrigonometricMutationManager::trigonometricMutation(int const i) const{
+void TrigonometricMutationManager::preMutation(){
+	while (centroids.size() < genomes.size())
+		centroids.push_back(new Solution(D));
+}
+
+// The centroid only depends on the parents, so it is laid out right away
+void TrigonometricMutationManager::draw(int const i, MutationDraw& d){
+	d.variant = rng.randDouble(0,1) <= gamma;
+
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 	
 	std::vector<Solution*> xr = pickRandom(possibilities, 3);
+	for (int k = 0; k < 3; k++)
+		d.x[k] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = xr[0];
+	if (!d.variant) // Rand/1
+		return;
 
 	double const pPrime = std::abs(xr[0]->getFitness()) + std::abs(xr[1]->getFitness()) 
 					+ std::abs(xr[2]->getFitness());
-
-	double const p0 = std::abs(xr[0]->getFitness()) / pPrime;
-	double const p1 = std::abs(xr[1]->getFitness()) / pPrime;
-	double const p2 = std::abs(xr[2]->getFitness()) / pPrime;
-
-	std::vector<double> mutant(D);
-
-	add(xr[0]->getX(), xr[1]->getX(), mutant);
-	add(mutant, xr[2]->getX(), mutant);
-	scale(mutant, 1./3.);
-
-	Solution base = Solution(mutant); // only used for correction strategies
-
-	std::vector<double> temp(D);
-	subtract(xr[0]->getX(), xr[1]->getX(), temp);
-	scale(temp, p1-p0);
-	add(temp, mutant, mutant);
-
-	subtract(xr[1]->getX(), xr[2]->getX(), temp);
-	scale(temp, p2-p1);
-	add(temp, mutant, mutant);
-
-	subtract(xr[2]->getX(), xr[0]->getX(), temp);
-	scale(temp, p0-p2);
-	add(temp, mutant, mutant);
-	
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, &base, genomes[i]);
-	return m;
+	for (int k = 0; k < 3; k++)
+		d.w[k] = std::abs(xr[k]->getFitness()) / pPrime;
+
+	double* const c = position(centroids[i]);
+	for (int j = 0; j < D; j++)
+		c[j] = (d.x[0][j] + d.x[1][j] + d.x[2][j]) * (1./3.);
+	d.x[3] = c;
+	d.base = centroids[i]; // only used for correction strategies
 }
 
-Solution* TrigonometricMutationManager::rand1Mutation(int const i) const{
-	std::vector<Solution*> possibilities = genomes;
-	possibilities.erase(possibilities.begin() + i);
-	
-	std::vector<Solution*> xr = pickRandom(possibilities, 3);
-
-	std::vector<double> mutant = xr[0]->getX();
-	std::vector<double> difference(D);
-	subtract(xr[1]->getX(), xr[2]->getX(), difference);
-	scale(difference, Fs[i]);
-	add(mutant,difference, mutant);
-
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, xr[0], genomes[i]);
-	return m;
+void TrigonometricMutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	if (!d.variant){
+		for (int j = from; j < to; j++)
+			x[j] = d.x[0][j] + (d.x[1][j] - d.x[2][j]) * d.F;
+		return;
+	}
+	double const* const p = d.w;
+	for (int j = from; j < to; j++){
+		double y = (d.x[0][j] - d.x[1][j]) * (p[1] - p[0]) + d.x[3][j];
+		y = (d.x[1][j] - d.x[2][j]) * (p[2] - p[1]) + y;
+		x[j] = (d.x[2][j] - d.x[0][j]) * (p[0] - p[2]) + y;
+	}
 }
 
 // Two-opt/1
-Solution* TwoOpt1MutationManager::mutate(int const i) const{
+void TwoOpt1MutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
@@ -332,19 +343,19 @@ Solution* TwoOpt1MutationManager::mutate(int const i) const{
 	if (xr[1]->getFitness() < xr[0]->getFitness())
 		std::swap(xr[0], xr[1]);
 
-	std::vector<double> mutant = xr[0]->getX();
-	std::vector<double> difference(D);
-	subtract(xr[1]->getX(), xr[2]->getX(), difference);
-	scale(difference, Fs[i]);
-	add(mutant,difference, mutant);
+	for (int k = 0; k < 3; k++)
+		d.x[k] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = xr[0];
+}
 
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, xr[0], genomes[i]);
-	return m;
+void TwoOpt1MutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[2][j]) * d.F;
 }
 
 // Two-opt/2
-Solution* TwoOpt2MutationManager::mutate(int const i) const{
+void TwoOpt2MutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
@@ -353,19 +364,15 @@ Solution* TwoOpt2MutationManager::mutate(int const i) const{
 	if (xr[1]->getFitness() < xr[0]->getFitness())
 		std::swap(xr[0], xr[1]);
 
-	std::vector<double> mutant = xr[0]->getX();
-	std::vector<double> difference(D);
-
-	subtract(xr[1]->getX(), xr[2]->getX(), difference);
-	add(difference, xr[3]->getX(), difference);
-	subtract(difference, xr[4]->getX(), difference);
-	scale(difference, Fs[i]);
-
-	add(mutant, difference, mutant);
+	for (int k = 0; k < 5; k++)
+		d.x[k] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = xr[0];
+}
 
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, xr[0], genomes[i]);
-	return m;
+void TwoOpt2MutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[2][j] + d.x[3][j] - d.x[4][j]) * d.F;
 }
 
 // Proximity-based Rand/1
@@ -409,7 +416,7 @@ void ProximityMutationManager::preMutation(){
 	}
 }
 
-Solution* ProximityMutationManager::mutate(int const i) const{
+void ProximityMutationManager::draw(int const i, MutationDraw& d){
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
@@ -417,15 +424,15 @@ Solution* ProximityMutationManager::mutate(int const i) const{
 	prob.erase(prob.begin() + i); // Remove own probability
 	std::vector<Solution*> xr = rouletteSelect(possibilities, prob, 3);
 
-	std::vector<double> mutant = xr[0]->getX();
-	std::vector<double> difference(D);
-	subtract(xr[1]->getX(), xr[2]->getX(), difference);
-	scale(difference, Fs[i]);
-	add(mutant,difference, mutant);
+	for (int k = 0; k < 3; k++)
+		d.x[k] = position(xr[k]);
+	d.F = Fs[i];
+	d.base = xr[0];
+}
 
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, xr[0], genomes[i]);
-	return m;
+void ProximityMutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[2][j]) * d.F;
 }
 
 // Ranking based
@@ -451,27 +458,26 @@ Solution* RankingMutationManager::pickRanked(std::vector<Solution*>& possibiliti
 	return pick;
 }
 
-Solution* RankingMutationManager::mutate(int const i) const{
+void RankingMutationManager::draw(int const i, MutationDraw& d){
 	Solution* pBest = getPBest(genomes); // pBest is sampled for each mutation
 
 	std::vector<Solution*> possibilities = genomes;
 	possibilities.erase(possibilities.begin() + i);
 
-	std::vector<double> mutant = genomes[i]->getX();
-	std::vector<double> difference(D);
-
 	Solution* xr0 = pickRanked(possibilities); // N.B. Ranked instead of Random
 
 	Solution* xr1 = pickRandom(possibilities);
 
-	subtract(pBest->getX(), genomes[i]->getX(), difference);
-	add(difference, xr0->getX(), difference);
-	subtract(difference, xr1->getX(), difference);
-	scale(difference,Fs[i]);
-
-	add(mutant, difference, mutant);
+	d.x[0] = position(genomes[i]);
+	d.x[1] = position(pBest);
+	d.x[2] = position(xr0);
+	d.x[3] = position(xr1);
+	d.F = Fs[i];
+	d.base = genomes[i];
+}
 
-	Solution* m = new Solution(mutant);
-	deCH->repairDE(m, genomes[i], genomes[i]);
-	return m;
+// Same as target-to-best/1
+void RankingMutationManager::build(MutationDraw const& d, double* const x, int const from, int const to) const{
+	for (int j = from; j < to; j++)
+		x[j] = d.x[0][j] + (d.x[1][j] - d.x[0][j] + d.x[2][j] - d.x[3][j]) * d.F;
 }
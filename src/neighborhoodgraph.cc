@@ -0,0 +1,288 @@
+#include "neighborhoodgraph.h"
+#include "particle.h"
+#include <algorithm>
+
+NeighborhoodGraph::NeighborhoodGraph(std::vector<Particle*> const& particles)
+	: particles(particles), N(particles.size()), offsets(N + 1, 0), words((N + 63) / 64),
+	layout(ROWS), all(N), best(0), clusterEdges(0), improvedBase(0), seen(N, -1){
+	for (int i = 0; i < N; i++)
+		all[i] = i;
+}
+
+void NeighborhoodGraph::build(std::vector<Edge> const& edges){
+	// A counting sort on the neighbor followed by a stable one on the particle
+	// leaves every row sorted
+	std::vector<int> start(N + 1, 0);
+	for (Edge const& e : edges)
+		start[e.second + 1]++;
+	for (int i = 0; i < N; i++)
+		start[i + 1] += start[i];
+	std::vector<Edge> byNeighbor(edges.size());
+	for (Edge const& e : edges)
+		byNeighbor[start[e.second]++] = e;
+
+	std::fill(start.begin(), start.end(), 0);
+	for (Edge const& e : edges)
+		start[e.first + 1]++;
+	for (int i = 0; i < N; i++)
+		start[i + 1] += start[i];
+	std::vector<int> sorted(edges.size());
+	std::vector<int> next(start.begin(), start.end() - 1);
+	for (Edge const& e : byNeighbor)
+		sorted[next[e.first]++] = e.second;
+
+	neighbors.clear();
+	neighbors.reserve(sorted.size());
+	bool loops = false;
+	for (int i = 0; i < N; i++){
+		offsets[i] = neighbors.size();
+		for (int k = start[i]; k < start[i + 1]; k++)
+			if (k == start[i] || sorted[k] != sorted[k - 1]){
+				neighbors.push_back(sorted[k]);
+				loops |= sorted[k] == i;
+			}
+	}
+	offsets[N] = neighbors.size();
+
+	if (!loops && N > 1 && (int64_t)neighbors.size() == int64_t(N) * (N - 1))
+		setComplete();
+	else {
+		layout = ROWS;
+		buildBits();
+		rewired();
+	}
+}
+
+// Drops the rows and finds the best with one pass over the swarm
+void NeighborhoodGraph::setComplete(){
+	layout = COMPLETE;
+	std::vector<int>().swap(neighbors);
+	std::vector<uint64_t>().swap(bits);
+	std::fill(offsets.begin(), offsets.end(), 0);
+	rewired();
+	best = 0;
+	for (int i = 1; i < N; i++)
+		if (particles[i]->getPbest() < particles[best]->getPbest())
+			best = i;
+}
+
+void NeighborhoodGraph::materialize(){
+	bool const logged = layout == CLUSTERS;
+	std::vector<int> rows;
+	rows.reserve(getNumberOfEdges());
+	for (int i = 0; i < N; i++){
+		offsets[i] = rows.size();
+		for (int const j : getNeighbors(i))
+			rows.push_back(j);
+	}
+	offsets[N] = rows.size();
+	neighbors.swap(rows);
+	layout = ROWS;
+	buildBits();
+	if (!logged) // A complete graph keeps no log to go on from
+		for (int& s : seen)
+			if (s >= 0)
+				s = -2;
+}
+
+void NeighborhoodGraph::buildBits(){
+	// The bitset takes N*N bits, the rows 32 bits per edge
+	if (int64_t(neighbors.size()) * 32 >= int64_t(N) * N){
+		bits.assign(std::size_t(N) * words, 0);
+		for (int i = 0; i < N; i++)
+			for (int k = offsets[i]; k < offsets[i + 1]; k++)
+				bits[std::size_t(i) * words + neighbors[k] / 64] |= uint64_t(1) << (neighbors[k] % 64);
+	} else
+		bits.clear();
+}
+
+// Logged improvements say nothing about the new rows. add and remove only
+// flag the rows they change.
+void NeighborhoodGraph::rewired(){
+	improved.clear();
+	improvedBase = 0;
+	std::fill(seen.begin(), seen.end(), -1);
+}
+
+int NeighborhoodGraph::size() const {
+	return N;
+}
+
+int NeighborhoodGraph::getNumberOfEdges() const {
+	if (layout == COMPLETE)
+		return N * (N - 1);
+	if (layout == CLUSTERS)
+		return clusterEdges;
+	return neighbors.size();
+}
+
+NeighborhoodGraph::Row NeighborhoodGraph::getNeighbors(int const i) const {
+	if (layout == COMPLETE)
+		return Row(all.data(), all.data() + N, all.data() + i);
+	if (layout == CLUSTERS)
+		return Row(members.data() + clusterStart[cluster[i]], members.data() + clusterStart[cluster[i] + 1], members.data() + position[i]);
+	return Row(neighbors.data() + offsets[i], neighbors.data() + offsets[i + 1]);
+}
+
+Particle* NeighborhoodGraph::getParticle(int const i) const {
+	return particles[i];
+}
+
+bool NeighborhoodGraph::isNeighbor(int const i, int const j) const {
+	if (layout == COMPLETE)
+		return i != j;
+	if (layout == CLUSTERS)
+		return i != j && cluster[i] == cluster[j];
+	if (!bits.empty())
+		return (bits[std::size_t(i) * words + j / 64] >> (j % 64)) & 1;
+	return std::binary_search(neighbors.begin() + offsets[i], neighbors.begin() + offsets[i + 1], j);
+}
+
+bool NeighborhoodGraph::isDense() const {
+	return layout == COMPLETE || !bits.empty();
+}
+
+bool NeighborhoodGraph::isComplete() const {
+	return layout == COMPLETE;
+}
+
+void NeighborhoodGraph::assign(std::vector<Edge> const& edges){
+	build(edges);
+}
+
+void NeighborhoodGraph::assignComplete(){
+	if (N > 1)
+		setComplete();
+	else
+		clear();
+}
+
+// A counting sort on the cluster lays out the members, so regrouping the
+// same number of clusters again allocates nothing
+void NeighborhoodGraph::assignClusters(std::vector<int> const& clusterOf){
+	int const K = N > 0 ? *std::max_element(clusterOf.begin(), clusterOf.end()) + 1 : 0;
+	if (K == 1){
+		assignComplete();
+		return;
+	}
+
+	cluster.assign(clusterOf.begin(), clusterOf.end());
+	clusterStart.assign(K + 1, 0);
+	for (int i = 0; i < N; i++)
+		clusterStart[cluster[i] + 1]++;
+	for (int c = 0; c < K; c++)
+		clusterStart[c + 1] += clusterStart[c];
+	members.resize(N);
+	position.resize(N);
+	for (int i = 0; i < N; i++){ // Leaves clusterStart[c] at the start of c + 1
+		position[i] = clusterStart[cluster[i]]++;
+		members[position[i]] = i;
+	}
+	for (int c = K; c > 0; c--)
+		clusterStart[c] = clusterStart[c - 1];
+	clusterStart[0] = 0;
+
+	clusterEdges = 0;
+	for (int c = 0; c < K; c++){
+		int const size = clusterStart[c + 1] - clusterStart[c];
+		clusterEdges += size * (size - 1);
+	}
+
+	layout = CLUSTERS;
+	neighbors.clear();
+	bits.clear();
+	rewired();
+}
+
+// add and remove merge the sorted changes into the sorted rows
+void NeighborhoodGraph::add(std::vector<Edge> const& edges){
+	if (layout == COMPLETE)
+		return; // Nothing left to add
+	if (layout == CLUSTERS)
+		materialize();
+	std::vector<Edge> added = edges;
+	std::sort(added.begin(), added.end());
+
+	std::vector<int> merged;
+	merged.reserve(neighbors.size() + added.size());
+	bool loops = false;
+	auto a = added.begin();
+	for (int i = 0; i < N; i++){
+		int const first = offsets[i], last = offsets[i + 1];
+		offsets[i] = merged.size();
+		int k = first;
+		if (a != added.end() && a->first == i && seen[i] >= 0)
+			seen[i] = -2; // Has to look at its new neighbors
+		while (k < last || (a != added.end() && a->first == i)){
+			int next;
+			if (a == added.end() || a->first != i || (k < last && neighbors[k] <= a->second))
+				next = neighbors[k++];
+			else
+				next = (a++)->second;
+			if ((int)merged.size() == offsets[i] || merged.back() != next){
+				merged.push_back(next);
+				loops |= next == i;
+			}
+		}
+	}
+	offsets[N] = merged.size();
+	neighbors.swap(merged);
+	if (!loops && (int64_t)neighbors.size() == int64_t(N) * (N - 1))
+		setComplete();
+	else
+		buildBits();
+}
+
+void NeighborhoodGraph::remove(std::vector<Edge> const& edges){
+	if (layout != ROWS)
+		materialize();
+	std::vector<Edge> removed = edges;
+	std::sort(removed.begin(), removed.end());
+
+	int kept = 0;
+	auto r = removed.begin();
+	for (int i = 0; i < N; i++){
+		int const first = offsets[i], last = offsets[i + 1];
+		offsets[i] = kept;
+		for (int k = first; k < last; k++){
+			Edge const e(i, neighbors[k]);
+			while (r != removed.end() && *r < e)
+				r++;
+			if (r == removed.end() || *r != e)
+				neighbors[kept++] = neighbors[k];
+			else
+				seen[i] = -1; // Its best may have been removed
+		}
+	}
+	offsets[N] = kept;
+	neighbors.resize(kept);
+	buildBits();
+}
+
+void NeighborhoodGraph::clear(){
+	build(std::vector<Edge>());
+}
+
+bool NeighborhoodGraph::isRewired(int const i) const {
+	return seen[i] == -1;
+}
+
+void NeighborhoodGraph::markImproved(int const i){
+	if (layout == COMPLETE){
+		if (particles[i]->getPbest() < particles[best]->getPbest())
+			best = i;
+		return;
+	}
+	improved.push_back(i);
+	if ((int)improved.size() <= 2 * N)
+		return;
+
+	// Keep the last N entries, whoever is further behind rescans its row,
+	// which is no longer than N
+	int const cut = improvedBase + improved.size() - N;
+	for (int& s : seen)
+		if (s >= 0 && s < cut)
+			s = -2;
+	improved.erase(improved.begin(), improved.end() - N);
+	improvedBase = cut;
+}
@@ -3,6 +3,7 @@
 #include "particleupdatemanager.h"
 #include "util.h"
 #include "rng.h"
+#include "parallel.h"
 #include <iostream>
 #include <algorithm>
 #include <functional>
@@ -12,29 +13,22 @@
 #include <IOHprofiler_experimenter.h>
 
 Particle::Particle(int const D, ParticleUpdateSettings const*const settings)
-	: Solution(D), v(D), p(D), g(D), pbest(std::numeric_limits<double>::max()), gbest(std::numeric_limits<double>::max()),
-		settings(settings), psoCH(settings->psoCH){
-	particleUpdateManager = updateManagers.at(settings->managerType)(x,v,p,g,settings->parameters,neighborhood);
+	: Solution(D), v(D), p(D), pbest(std::numeric_limits<double>::max()), best(this), g(&p),
+		neighborhood(NULL), index(0), particleUpdateManager(settings->manager), settings(settings), psoCH(settings->psoCH){
 }
 
 Particle::Particle(Particle const & other)
-	: Solution(other.D), v(other.v), p(other.p), g(other.g),
-	pbest(other.pbest), gbest(other.gbest), 
-	neighborhood(other.neighborhood), particleUpdateManager(NULL),
+	: Solution(other.D), v(other.v), p(other.p),
+	pbest(other.pbest), best(other.best == &other ? this : other.best), g(&best->p),
+	neighborhood(other.neighborhood), index(other.index), particleUpdateManager(other.particleUpdateManager),
 	settings(other.settings), psoCH(other.psoCH){
 
 	x = other.x;
 	evaluated=other.evaluated;
 	fitness = other.fitness;
-
-	if (settings != NULL) // This constructor is used also by DE
-		particleUpdateManager = updateManagers.at(settings->managerType)(x,v,p,g,settings->parameters,neighborhood);
 }
 
-Particle::~Particle(){
-	if (particleUpdateManager != NULL)
-		delete particleUpdateManager;
-}
+Particle::~Particle(){}
 
 std::vector<double> Particle::getV() const {
 	return v;
@@ -52,40 +46,100 @@ void Particle::setV(int const dim, double val){
 	this->v[dim] = val;
 }
 
-void Particle::addNeighbor(Particle* const neighbor){
-	neighborhood.push_back(neighbor);
+void Particle::setNeighborhood(NeighborhoodGraph* const neighborhood, int const index){
+	this->neighborhood = neighborhood;
+	this->index = index;
+}
+
+NeighborhoodGraph const* Particle::getNeighborhood() const {
+	return neighborhood;
 }
 
-void Particle::removeNeighbor(Particle* const neighbor){
-	neighborhood.erase(std::remove(neighborhood.begin(), neighborhood.end(), neighbor), neighborhood.end());
+NeighborhoodGraph::Row Particle::getNeighbors() const {
+	if (neighborhood == NULL)
+		return NeighborhoodGraph::Row(NULL, NULL);
+	return neighborhood->getNeighbors(index);
 }
 
-void Particle::removeAllNeighbors(){
-	neighborhood.clear();
+int Particle::getIndex() const {
+	return index;
+}
+
+void Particle::move(double const progress){
+	if (psoCH->repairsVelocityPre()){
+		particleUpdateManager->updateVelocity(*this, progress);
+		psoCH->repairVelocityPre(this);
+		particleUpdateManager->updatePosition(*this);
+	} else
+		particleUpdateManager->update(*this, progress);
+}
+
+// Computes a candidate into xNext and vNext
+void Particle::propose(double const progress){
+	xNext.resize(D);
+	vNext.resize(D);
+	if (psoCH->repairsVelocityPre()){ // The handler works on the particle itself
+		xNext = x;
+		vNext = v;
+		x.swap(xNext);
+		v.swap(vNext);
+		move(progress);
+		x.swap(xNext);
+		v.swap(vNext);
+	} else
+		particleUpdateManager->propose(*this, progress, xNext, vNext);
 }
 
 void Particle::updateVelocityAndPosition(double progress){
 	evaluated = false;
-	std::vector<double> const oldV = v;
-	std::vector<double> const oldX = x;
-	int resamples = 0;
+	if (psoCH->canResample()){
+		// Candidates are swapped in for the check and swapped out again when
+		// rejected, so the current position and velocity are never copied
+		for (int resamples = 0; ; resamples++){
+			propose(progress);
+			x.swap(xNext);
+			v.swap(vNext);
+			if (!psoCH->resample(this, resamples))
+				break;
+			x.swap(xNext);
+			v.swap(vNext);
+		}
+	} else
+		move(progress);
+	psoCH->repair(this); // Generic repair
+}
 
-	while(true){
-		particleUpdateManager->updateVelocity(progress);
-		psoCH->repairVelocityPre(this);
-		particleUpdateManager->updatePosition();
-		if (psoCH->resample(this, resamples)){
-			x = oldX; // reset position and velocity
-			v = oldV;
-			resamples++;
-		} else 
-			break;
+// Falls back to particle by particle when the handler has to step in
+// between the draws, or the rule cannot draw ahead
+void Particle::updateSwarm(std::vector<Particle*> const& particles, double const progress, int const threads){
+	if (particles.empty())
+		return;
+	PSOConstraintHandler* const psoCH = particles[0]->psoCH;
+	ParticleUpdateManager* const manager = particles[0]->particleUpdateManager;
+	if (psoCH->canResample() || psoCH->repairsVelocityPre() || !manager->drawsAhead()){
+		for (Particle* const p : particles)
+			p->updateVelocityAndPosition(progress);
+		return;
 	}
-	psoCH->repair(this); // Generic repair
+
+	for (Particle* const p : particles)
+		manager->draw(*p);
+
+	// Blocks of about 4096 entries keep the hand-out cheap next to the work
+	int const N = particles.size();
+	int const block = std::max(1, 4096 / particles[0]->D);
+	parallelFor((N + block - 1) / block, threads, [&](int const b){
+		for (int i = b * block; i < std::min(N, (b + 1) * block); i++)
+			manager->apply(*particles[i], progress);
+	});
+
+	for (Particle* const p : particles)
+		p->evaluated = false;
+	psoCH->repairAll(particles); // Generic repair
 }
 
 double Particle::getGbest() const {
-	return gbest;
+	return best->pbest;
 }
 
 double Particle::getPbest() const {
@@ -96,50 +150,43 @@ double Particle::getP(int const i) const {
 	return p[i];
 }
 
-std::vector<double> Particle::getG() const {
-	return g;
+std::vector<double> const& Particle::getG() const {
+	return *g;
 }
 
-std::vector<double> Particle::getP() const {
+std::vector<double> const& Particle::getP() const {
 	return p;
 }
 
+// The best is followed by reference, so its improvements need no copying and
+// only neighbors that improved since the last call have to be compared
 void Particle::updateGbest(){
-	int bestNeighbor = -1;
+	if (neighborhood != NULL && neighborhood->isRewired(index))
+		best = this; // The old best may no longer be a neighbor
 
-	if (fitness < gbest){ // First check own fitness
-		gbest = fitness;
-		g = x;
-	}
+	if (pbest < best->pbest) // First check own pbest
+		best = this;
 
-	double bestScore = gbest;
-	for (unsigned int i = 0; i < neighborhood.size(); i++){ // Check neighbors fitness
-		double const currentScore = neighborhood[i]->getPbest();
-		if (currentScore < bestScore){
-			bestScore = currentScore;
-			bestNeighbor = i;
-		}
-	}
-
-	if (bestNeighbor != -1){ // Update gbest
-		gbest = bestScore;
-		g = neighborhood[bestNeighbor]->getG();
-	}
+	if (neighborhood != NULL)
+		neighborhood->forImprovedNeighbors(index, [this](int const i){
+			Particle const* const neighbor = neighborhood->getParticle(i);
+			if (neighbor->pbest < best->pbest)
+				best = neighbor;
+		});
+	g = &best->p;
 }
 
 void Particle::updatePbest(){
 	if (fitness < pbest){
 		pbest = fitness;
 		p = x;
+		if (neighborhood != NULL)
+			neighborhood->markImproved(index);
 	}
 }
 
-bool Particle::isNeighbor(Particle* particle) const {
-	return std::find(neighborhood.begin(), neighborhood.end(), particle) != neighborhood.end();
-}
-
 int Particle::getNumberOfNeighbors() const{
-	return neighborhood.size();
+	return getNeighbors().size();
 }
 
 void Particle::setXandUpdateV(std::vector<double> x, double fitness){
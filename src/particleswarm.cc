@@ -8,13 +8,29 @@
 #include <limits>
 #include <iostream>
 #include <fstream>
-#include "logger.h"
+#include "util.h"
+#include "trajectory.h"
+#include "snapshottrigger.h"
+#include "livefeed.h"
+#include "runarchive.h"
 
-ParticleSwarm::ParticleSwarm(PSOConfig const config) : config(config){
+ParticleSwarm::ParticleSwarm(PSOConfig const config) : config(config), threads(1){
 }
 
 void ParticleSwarm::reset(){}
 
+void ParticleSwarm::setLogSettings(LogSettings const logSettings){
+	this->logSettings = logSettings;
+}
+
+void ParticleSwarm::setEvaluationSettings(EvaluationSettings const evaluationSettings){
+	this->evaluationSettings = evaluationSettings;
+}
+
+void ParticleSwarm::setThreads(int const threads){
+	this->threads = threads;
+}
+
 ParticleSwarm::~ParticleSwarm(){}
 
 void ParticleSwarm::run(std::shared_ptr<IOHprofiler_problem<double> > const problem, 
@@ -36,39 +52,72 @@ void ParticleSwarm::runAsynchronous(std::shared_ptr<IOHprofiler_problem<double>
 	std::vector<double> const upperBound = problem->IOHprofiler_get_upperbound();
 
 	PSOConstraintHandler* const psoCH = psoCHs.at(config.constraintHandler)(lowerBound, upperBound); 
-	ParticleUpdateSettings const settings(config.update, particleUpdateParams, psoCH);
+	ParticleUpdateManager* const updateManager = updateManagers.at(config.update)(D, particleUpdateParams);
+	ParticleUpdateSettings const settings(updateManager, psoCH);
 
+	EvaluationBuffer evaluations(problem, logSettings.csv ? logger : nullptr, logSettings.aggregator, evalBudget, evaluationSettings);
 	std::vector<Particle*> particles(popSize);
 	for (int i = 0; i < popSize; i++){
 		particles[i] = new Particle(D, &settings);
 		particles[i]->randomize(lowerBound, upperBound);
 	}
 
-	TopologyManager* const topologyManager = topologies.at(config.topology)(particles);
+	TopologyManager* const topologyManager = topologies.at(config.topology)(particles, particleUpdateParams);
 
-	Logger loggerAnimation("scratch/animations/" + getIdString() + "_f" +
+	TrajectoryWriter trajectory(logSinks.at(logSettings.sink)(checkFilename("scratch/animations/" + getIdString() + "_f" +
 			std::to_string(problem->IOHprofiler_get_problem_id()) + "D" + std::to_string(D) + 
-			".log");
+			".traj", logSettings.sink), false), popSize, D, problem->IOHprofiler_get_problem_id(), getIdString());
+	SnapshotTrigger* const animationTrigger = createSnapshotTrigger(logSettings.animationTrigger);
+	LiveFeedWriter liveFeed(logSettings.liveFeed, popSize, D, problem->IOHprofiler_get_problem_id());
 
-	while (	problem->IOHprofiler_get_evaluations() < evalBudget &&
+	int iteration = 0;
+
+	while (	evaluations.getSpent() < evalBudget &&
 			!problem->IOHprofiler_hit_optimal()){
 
 		for (Particle* p : particles){
-			p->evaluate(problem,logger);
+			p->evaluate(evaluations);
 			p->updatePbest();
 			p->updateGbest();
-			p->updateVelocityAndPosition(double(problem->IOHprofiler_get_evaluations())/evalBudget);			
+			p->updateVelocityAndPosition(double(evaluations.getSpent())/evalBudget);			
 		}
 
-		topologyManager->update(double(problem->IOHprofiler_get_evaluations())/evalBudget);	
-		loggerAnimation.log(particles);
+		topologyManager->update(double(evaluations.getSpent())/evalBudget);	
+		evaluations.flush();
+		if (animationTrigger->fire(iteration, evaluations.getSpent(), evalBudget, particles))
+			trajectory.log(particles);
+		liveFeed.publish(particles);
+		iteration++;
 	}
 
+	delete animationTrigger;
 	delete topologyManager;
+	archive(problem, particles, psoCH);
 	for (Particle* particle : particles)
 		delete particle;
 	particles.clear();
+	if (evaluationSettings.counters != NULL)
+		evaluationSettings.counters->addResamples(psoCH->getResampleHistogram());
 	delete psoCH;
+	delete updateManager;
+}
+
+// The best personal best stands for the swarm; there is one correction rate per
+// run, repeated to the three DE logs at least
+void ParticleSwarm::archive(std::shared_ptr<IOHprofiler_problem<double> > const problem,
+		std::vector<Particle*> const& particles, PSOConstraintHandler const* const psoCH) const {
+	if (logSettings.archive == NULL)
+		return;
+
+	Particle const* best = particles[0];
+	for (Particle const* const p : particles)
+		if (p->getPbest() < best->getPbest())
+			best = p;
+
+	int const evaluations = problem->IOHprofiler_get_evaluations();
+	logSettings.archive->add(RunRecord{getIdString(), problem->IOHprofiler_get_problem_id(),
+		problem->IOHprofiler_get_number_of_variables(),
+		std::vector<double>(3, double(psoCH->getCorrections()) / evaluations), best->getP(), best->getPbest(), evaluations});
 }
 
 void ParticleSwarm::runSynchronous(std::shared_ptr<IOHprofiler_problem<double> > const problem, 
@@ -80,38 +129,47 @@ void ParticleSwarm::runSynchronous(std::shared_ptr<IOHprofiler_problem<double> >
 	std::vector<double> const upperBound = problem->IOHprofiler_get_upperbound(); 
 
 	PSOConstraintHandler* const psoCH = psoCHs.at(config.constraintHandler)(lowerBound, upperBound); 
-	ParticleUpdateSettings const settings(config.update, particleUpdateParams, psoCH);
+	ParticleUpdateManager* const updateManager = updateManagers.at(config.update)(D, particleUpdateParams);
+	ParticleUpdateSettings const settings(updateManager, psoCH);
 
+	EvaluationBuffer evaluations(problem, logSettings.csv ? logger : nullptr, logSettings.aggregator, evalBudget, evaluationSettings);
 	std::vector<Particle*> particles(popSize);
 	for (int i = 0; i < popSize; i++){
 		particles[i] = new Particle(D, &settings);
 		particles[i]->randomize(lowerBound, upperBound);
 	}
 
-	TopologyManager* const topologyManager = topologies.at(config.topology)(particles);
+	TopologyManager* const topologyManager = topologies.at(config.topology)(particles, particleUpdateParams);
+	LiveFeedWriter liveFeed(logSettings.liveFeed, popSize, D, problem->IOHprofiler_get_problem_id());
 
-	while (	problem->IOHprofiler_get_evaluations() < evalBudget &&
+	while (	evaluations.getSpent() < evalBudget &&
 			!problem->IOHprofiler_hit_optimal()){
 		
 		for (Particle* p : particles){
-			p->evaluate(problem,logger);
+			p->evaluate(evaluations);
 			p->updatePbest();
 		}
 
-		for (Particle* p : particles){
+		for (Particle* p : particles)
 			p->updateGbest();
-			p->updateVelocityAndPosition(double(problem->IOHprofiler_get_evaluations())/evalBudget);
-		}
+
+		Particle::updateSwarm(particles, double(evaluations.getSpent())/evalBudget, threads);
 
 	
-		topologyManager->update(double(problem->IOHprofiler_get_evaluations())/evalBudget);	
+		topologyManager->update(double(evaluations.getSpent())/evalBudget);	
+		evaluations.flush();
+		liveFeed.publish(particles);
 	}
 
 	delete topologyManager;
+	archive(problem, particles, psoCH);
 	for (Particle* particle : particles)
 		delete particle;
 	particles.clear();
+	if (evaluationSettings.counters != NULL)
+		evaluationSettings.counters->addResamples(psoCH->getResampleHistogram());
 	delete psoCH;
+	delete updateManager;
 }
 
 std::string ParticleSwarm::getIdString() const {
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include "particle.h"
 #include "particleupdatemanager.h"
 #include "particleupdatesettings.h"
@@ -10,31 +11,118 @@
 #include "rng.h"
 
 /*		Base 		*/
-ParticleUpdateManager::ParticleUpdateManager(std::vector<double>& x, std::vector<double>& v,
-	std::vector<double>const& p, std::vector<double>const& g)
-	:x(x), v(v), p(p), g(g), D(x.size()){
+ParticleUpdateManager::ParticleUpdateManager(int const D)
+	:D(D){
 }
 
 ParticleUpdateManager::~ParticleUpdateManager(){}
 
-void ParticleUpdateManager::updatePosition(){
+std::vector<double>& ParticleUpdateManager::position(Particle& particle){
+	return particle.x;
+}
+
+std::vector<double>& ParticleUpdateManager::velocity(Particle& particle){
+	return particle.v;
+}
+
+void ParticleUpdateManager::updatePosition(Particle& particle){
+		std::vector<double>& x = position(particle);
+		std::vector<double>& v = velocity(particle);
 		std::transform (x.begin(), x.end(),
 				v.begin(), x.begin(),
 		std::plus<double>());
 }
 
-void ParticleUpdateManager::updateVelocity(double const progress){
+void ParticleUpdateManager::updateVelocity(Particle& particle, double const progress){
+		std::vector<double>& x = position(particle);
+		std::vector<double>& v = velocity(particle);
 		std::transform (x.begin(), x.end(),
 				v.begin(), x.begin(),
 		std::plus<double>());
 }
 
-#define LC(X) [](std::vector<double>& x, std::vector<double>& v,\
-			std::vector<double>const& p, std::vector<double>const& g, \
-			std::map<int, double> parameters, std::vector<Particle*>& neighborhood){return new X(x,v,p,g, parameters, neighborhood);}
+void ParticleUpdateManager::update(Particle& particle, double const progress){
+	updateVelocity(particle, progress);
+	updatePosition(particle);
+}
+
+// Runs the update in place on copies swapped into x and v
+void ParticleUpdateManager::propose(Particle& particle, double const progress, std::vector<double>& xNew, std::vector<double>& vNew){
+	std::vector<double>& x = position(particle);
+	std::vector<double>& v = velocity(particle);
+	xNew = x;
+	vNew = v;
+	x.swap(xNew);
+	v.swap(vNew);
+	update(particle, progress);
+	x.swap(xNew);
+	v.swap(vNew);
+}
+
+bool ParticleUpdateManager::drawsAhead() const {
+	return false;
+}
+
+void ParticleUpdateManager::draw(Particle const& particle){}
+
+void ParticleUpdateManager::apply(Particle& particle, double const progress){
+	update(particle, progress);
+}
+
+/*		Draw ahead 		*/
+DrawAheadManager::DrawAheadManager(int const D)
+	: ParticleUpdateManager(D){}
+
+std::vector<double>& DrawAheadManager::drawnFor(Particle const& particle){
+	if (particle.getIndex() >= (int)drawn.size())
+		drawn.resize(particle.getIndex() + 1);
+	return drawn[particle.getIndex()];
+}
+
+std::vector<double> const& DrawAheadManager::drawnBy(Particle const& particle) const {
+	return drawn[particle.getIndex()];
+}
+
+void DrawAheadManager::updateVelocity(Particle& particle, double const progress){
+	draw(particle);
+	move(particle, progress, NULL, velocity(particle).data());
+}
+
+void DrawAheadManager::update(Particle& particle, double const progress){
+	draw(particle);
+	move(particle, progress, position(particle).data(), velocity(particle).data());
+}
+
+void DrawAheadManager::propose(Particle& particle, double const progress, std::vector<double>& xNew, std::vector<double>& vNew){
+	draw(particle);
+	move(particle, progress, xNew.data(), vNew.data());
+}
+
+bool DrawAheadManager::drawsAhead() const {
+	return true;
+}
 
-std::map<std::string, std::function<ParticleUpdateManager* (std::vector<double>&, std::vector<double>&,
-		std::vector<double>const&, std::vector<double>const&, std::map<int,double>, std::vector<Particle*>&)>> const updateManagers({
+void DrawAheadManager::apply(Particle& particle, double const progress){
+	move(particle, progress, position(particle).data(), velocity(particle).data());
+}
+
+// vOut = chi * (w * v + r1 * (p - x) + r2 * (g - x)), clamped to vMax, and
+// xOut = x + vOut unless xOut is NULL; the outputs may alias x and v
+static inline void velocityKernel(double const* const x, double const* const v, double const* const p, double const* const g,
+		double const* const r1, double const* const r2, int const D, double const w, double const chi, double const vMax,
+		double* const xOut, double* const vOut){
+	#pragma omp simd
+	for (int i = 0; i < D; i++){
+		double const vi = std::min(std::max(chi * (w * v[i] + r1[i] * (p[i] - x[i]) + r2[i] * (g[i] - x[i])), -vMax), vMax);
+		if (xOut != NULL)
+			xOut[i] = x[i] + vi;
+		vOut[i] = vi;
+	}
+}
+
+#define LC(X) [](int const D, std::map<int, double> parameters){return new X(D, parameters);}
+
+std::map<std::string, std::function<ParticleUpdateManager* (int const, std::map<int,double>)>> const updateManagers({
 		{"I", LC(InertiaWeightManager)},
 		{"D", LC(DecrInertiaWeightManager)},
 		{"C", LC(ConstrictionCoefficientManager)},
@@ -43,105 +131,154 @@ std::map<std::string, std::function<ParticleUpdateManager* (std::vector<double>&
 });
 
 /*		Inertia weight 		*/
-InertiaWeightManager::InertiaWeightManager (std::vector<double>& x, std::vector<double>& v,
-	std::vector<double>const& p, std::vector<double>const& g,  std::map<int, double> parameters, std::vector<Particle*>& neighborhood)
-	: ParticleUpdateManager(x,v,p,g),
+InertiaWeightManager::InertiaWeightManager (int const D, std::map<int, double> parameters)
+	: DrawAheadManager(D),
 	phi1 (parameters.find(Setting::S_INER_PHI1) != parameters.end() ? parameters[Setting::S_INER_PHI1] : INER_PHI1_DEFAULT),
 	phi2 (parameters.find(Setting::S_INER_PHI2) != parameters.end() ? parameters[Setting::S_INER_PHI2] : INER_PHI2_DEFAULT),	
-	w (parameters.find(Setting::S_INER_W) != parameters.end() ? parameters[Setting::S_INER_W] : INER_W_DEFAULT){}
+	w (parameters.find(Setting::S_INER_W) != parameters.end() ? parameters[Setting::S_INER_W] : INER_W_DEFAULT),
+	vMax (parameters.find(Setting::S_VMAX) != parameters.end() ? parameters[Setting::S_VMAX] : std::numeric_limits<double>::infinity()){}
+
+void InertiaWeightManager::draw(Particle const& particle){
+	std::vector<double>& r = drawnFor(particle);
+	r.resize(2 * D);
+	rng.uniformFill(r.data(), r.data() + D, 0, phi1);
+	rng.uniformFill(r.data() + D, r.data() + 2 * D, 0, phi2);
+}
 
-void InertiaWeightManager::updateVelocity(double const progress) {
-	std::vector<double> pMinx(D);
-	subtract(p,x,pMinx);
-	std::vector<double> gMinx(D);	
-	subtract(g,x,gMinx);
-	randomMult(pMinx, 0, phi1);
-	randomMult(gMinx, 0, phi2);	
-	scale(v, w);
-	add(v,pMinx, v);
-	add(v,gMinx, v);
+void InertiaWeightManager::move(Particle& particle, double const progress, double* const xOut, double* const vOut){
+	double const* const r = drawnBy(particle).data();
+	velocityKernel(position(particle).data(), velocity(particle).data(), particle.getP().data(), particle.getG().data(),
+		r, r + D, D, w, 1., vMax, xOut, vOut);
 }
 
 /*	Decreasing inertia weight manager */
-DecrInertiaWeightManager::DecrInertiaWeightManager (std::vector<double>& x, std::vector<double>& v,
-	std::vector<double>const& p, std::vector<double>const& g,  std::map<int, double> parameters, std::vector<Particle*>& neighborhood)
-	: ParticleUpdateManager(x,v,p,g),
+DecrInertiaWeightManager::DecrInertiaWeightManager (int const D, std::map<int, double> parameters)
+	: DrawAheadManager(D),
 	phi1 (parameters.find(Setting::S_DINER_PHI1) != parameters.end() ? parameters[Setting::S_DINER_PHI1] : DINER_PHI2_DEFAULT),
 	phi2 (parameters.find(Setting::S_DINER_PHI2) != parameters.end() ? parameters[Setting::S_DINER_PHI2] : DINER_PHI2_DEFAULT),	
 	wMin (parameters.find(Setting::S_DINER_W_END) != parameters.end() ? parameters[Setting::S_DINER_W_END] : DINER_W_END_DEFAULT),
-	wMax(parameters.find(Setting::S_DINER_W_START) != parameters.end() ? parameters[Setting::S_DINER_W_START] : DINER_W_START_DEFAULT){}
+	wMax(parameters.find(Setting::S_DINER_W_START) != parameters.end() ? parameters[Setting::S_DINER_W_START] : DINER_W_START_DEFAULT),
+	vMax (parameters.find(Setting::S_VMAX) != parameters.end() ? parameters[Setting::S_VMAX] : std::numeric_limits<double>::infinity()){}
 
-void DecrInertiaWeightManager::updateVelocity(double const progress) {
-	std::vector<double> pMinx(D);
-	subtract(p,x,pMinx);
-	std::vector<double> gMinx(D);
-	subtract(g,x,gMinx);
-	randomMult(pMinx, 0, phi1);
-	randomMult(gMinx, 0, phi2);
-	scale(v,wMax - progress * (wMax - wMin));
-	add(v,pMinx, v);
-	add(v,gMinx,v);
+void DecrInertiaWeightManager::draw(Particle const& particle){
+	std::vector<double>& r = drawnFor(particle);
+	r.resize(2 * D);
+	rng.uniformFill(r.data(), r.data() + D, 0, phi1);
+	rng.uniformFill(r.data() + D, r.data() + 2 * D, 0, phi2);
+}
+
+void DecrInertiaWeightManager::move(Particle& particle, double const progress, double* const xOut, double* const vOut){
+	double const* const r = drawnBy(particle).data();
+	velocityKernel(position(particle).data(), velocity(particle).data(), particle.getP().data(), particle.getG().data(),
+		r, r + D, D, wMax - progress * (wMax - wMin), 1., vMax, xOut, vOut);
 }
 
 /*		Constriction Coefficient 		*/
-ConstrictionCoefficientManager::ConstrictionCoefficientManager(std::vector<double> & x, std::vector<double> & v,
-	std::vector<double>const& p, std::vector<double>const& g,  std::map<int, double> parameters, std::vector<Particle*>& neighborhood)
-	: ParticleUpdateManager(x,v,p,g),
+ConstrictionCoefficientManager::ConstrictionCoefficientManager(int const D, std::map<int, double> parameters)
+	: DrawAheadManager(D),
 	phi1 (parameters.find(Setting::S_CC_PHI1) != parameters.end() ? parameters[Setting::S_CC_PHI1] : CC_PHI1_DEFAULT),
 	phi2 (parameters.find(Setting::S_CC_PHI2) != parameters.end() ? parameters[Setting::S_CC_PHI2] : CC_PHI2_DEFAULT),
-	chi (2.0 / ((phi1+phi2) - 2 + sqrt(pow(phi1+phi2, 2.0) - 4 * (phi1+phi2)))){}
+	chi (2.0 / ((phi1+phi2) - 2 + sqrt(pow(phi1+phi2, 2.0) - 4 * (phi1+phi2)))),
+	vMax (parameters.find(Setting::S_VMAX) != parameters.end() ? parameters[Setting::S_VMAX] : std::numeric_limits<double>::infinity()){}
+
+void ConstrictionCoefficientManager::draw(Particle const& particle){
+	std::vector<double>& r = drawnFor(particle);
+	r.resize(2 * D);
+	rng.uniformFill(r.data(), r.data() + D, 0, phi1);
+	rng.uniformFill(r.data() + D, r.data() + 2 * D, 0, phi2);
+}
 
-void ConstrictionCoefficientManager::updateVelocity(double const progress){
-	std::vector<double> pMinx(D);
-	subtract(p,x,pMinx);
-	std::vector<double> gMinx(D);
-	subtract(g,x,gMinx);
-	randomMult(pMinx, 0, phi1);
-	randomMult(gMinx, 0, phi2);
-	add(v,pMinx,v);
-	add(v,gMinx,v);
-	scale(v, chi);
+void ConstrictionCoefficientManager::move(Particle& particle, double const progress, double* const xOut, double* const vOut){
+	double const* const r = drawnBy(particle).data();
+	velocityKernel(position(particle).data(), velocity(particle).data(), particle.getP().data(), particle.getG().data(),
+		r, r + D, D, 1., chi, vMax, xOut, vOut);
 }
 
 /*		Fully Informed 		*/
-FIPSManager::FIPSManager(std::vector<double> & x, std::vector<double> & v,
-	std::vector<double>const& p, std::vector<double>const& g,  std::map<int, double> parameters
-	, std::vector<Particle*>& neighborhood)
-	: ParticleUpdateManager(x,v,p,g),
+FIPSManager::FIPSManager(int const D, std::map<int, double> parameters)
+	: DrawAheadManager(D),
 	phi (parameters.find(Setting::S_FIPS_PHI) != parameters.end() ? parameters[Setting::S_FIPS_PHI] : FIPS_PHI_DEFAULT),
-	chi (2.0 / ((phi) -2 + sqrt( pow(phi, 2.0) - 4 * (phi)))),
-	neighborhood(neighborhood){}
+	chi (2.0 / ((phi) -2 + sqrt( pow(phi, 2.0) - 4 * (phi)))){}
 
 
-void FIPSManager::updateVelocity(double const progress){
-	std::vector<double> sum(D,0.0);
-	std::vector<double> pMinx(D);
+void FIPSManager::draw(Particle const& particle){
+	std::vector<double>& weights = drawnFor(particle);
+	weights.resize(particle.getNumberOfNeighbors());
+	rng.uniformFill(weights, 0, phi);
+}
 
-	std::vector< std::vector<double> > p_n;
-	p_n.reserve(neighborhood.size());
-	for (Particle* n : neighborhood)
-		p_n.push_back(n->getP());
+// Sums weights[k] * (p_k - x) straight from the pbest rows, four rows per
+// pass over sum; every element still adds the terms in neighbor order
+void FIPSManager::move(Particle& particle, double const progress, double* const xOut, double* const vOut){
+	thread_local std::vector<double> sum; // Per thread, so a swarm can move in parallel
+	sum.assign(D, 0.);
 
-	for (int i = 0; i < (int) neighborhood.size(); i++){
-		subtract(p_n[i], x, pMinx);
-		scale(pMinx, rng.randDouble(0,phi));
-		add(sum, pMinx, sum);		
+	NeighborhoodGraph::Row const neighbors = particle.getNeighbors();
+	NeighborhoodGraph const* const graph = particle.getNeighborhood();
+	std::vector<double> const& weights = drawnBy(particle);
+	int const n = weights.size();
+	double* const s = sum.data();
+	double const* const y = position(particle).data();
+	double const* const v = velocity(particle).data();
+	int k = 0;
+	for (; k + 4 <= n; k += 4){
+		double const* const p0 = graph->getParticle(neighbors[k])->getP().data();
+		double const* const p1 = graph->getParticle(neighbors[k + 1])->getP().data();
+		double const* const p2 = graph->getParticle(neighbors[k + 2])->getP().data();
+		double const* const p3 = graph->getParticle(neighbors[k + 3])->getP().data();
+		double const w0 = weights[k], w1 = weights[k + 1], w2 = weights[k + 2], w3 = weights[k + 3];
+		#pragma omp simd
+		for (int i = 0; i < D; i++)
+			s[i] = s[i] + (p0[i] - y[i]) * w0 + (p1[i] - y[i]) * w1 + (p2[i] - y[i]) * w2 + (p3[i] - y[i]) * w3;
+	}
+	for (; k < n; k++){
+		double const* const pk = graph->getParticle(neighbors[k])->getP().data();
+		double const wk = weights[k];
+		#pragma omp simd
+		for (int i = 0; i < D; i++)
+			s[i] = s[i] + (pk[i] - y[i]) * wk;
 	}
 
-	scale(sum, 1.0/neighborhood.size());
-	add(v,sum,v);
-	scale(v, chi);
+	double const mean = 1.0 / n;
+	#pragma omp simd
+	for (int i = 0; i < D; i++){
+		double const vi = (v[i] + s[i] * mean) * chi;
+		if (xOut != NULL)
+			xOut[i] = y[i] + vi;
+		vOut[i] = vi;
+	}
 }
 
 /* 		Bare Bones 		*/
-BareBonesManager::BareBonesManager(std::vector<double> & x, std::vector<double> & v,
-	std::vector<double>const& p, std::vector<double>const& g,  std::map<int, double> parameters, std::vector<Particle*>& neighborhood) :
-	ParticleUpdateManager(x,v,p,g) {}
+BareBonesManager::BareBonesManager(int const D, std::map<int, double> parameters)
+	: DrawAheadManager(D) {}
 
-void BareBonesManager::updatePosition(){
-	for (int i = 0; i < D; i++){
-		x[i] = rng.normalDistribution((g[i] + p[i]) / 2.0, std::abs(g[i] - p[i]));
-	}
+void BareBonesManager::draw(Particle const& particle){
+	std::vector<double>& z = drawnFor(particle);
+	z.resize(D);
+	rng.normalFill(z.data(), z.data() + D);
+}
+
+// x ~ N((g + p) / 2, |g - p|) as mean + z * spread, which is the mean itself
+// where g and p agree; the velocity is carried along unchanged
+void BareBonesManager::move(Particle& particle, double const progress, double* const xOut, double* const vOut){
+	std::vector<double> const& v = velocity(particle);
+	if (vOut != v.data())
+		std::copy(v.begin(), v.end(), vOut);
+	if (xOut == NULL)
+		return;
+
+	double const* const z = drawnBy(particle).data();
+	double const* const p = particle.getP().data();
+	double const* const g = particle.getG().data();
+	#pragma omp simd
+	for (int i = 0; i < D; i++)
+		xOut[i] = (g[i] + p[i]) * 0.5 + z[i] * std::abs(g[i] - p[i]);
+}
+
+void BareBonesManager::updatePosition(Particle& particle){
+	draw(particle);
+	move(particle, 0, position(particle).data(), velocity(particle).data());
 }
 
-void BareBonesManager::updateVelocity(double const progress){ /* Do nothing*/ }
+void BareBonesManager::updateVelocity(Particle& particle, double const progress){ /* Do nothing*/ }
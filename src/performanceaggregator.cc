@@ -0,0 +1,159 @@
+#include "performanceaggregator.h"
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+
+PerformanceAggregator::PerformanceAggregator(std::string const config, std::vector<double> const targets)
+	: config(config), targets(targets), function(0), D(0), budget(0), optimum(0.), nextTarget(0), hits(targets.size()){}
+
+std::vector<double> PerformanceAggregator::defaultTargets(){
+	std::vector<double> targets(51);
+	for (int i = 0; i < 51; i++)
+		targets[i] = std::pow(10., 2. - 0.2 * i);
+	return targets;
+}
+
+void PerformanceAggregator::startRun(int const function, int const D, double const optimum, int const budget){
+	this->function = function;
+	this->D = D;
+	this->optimum = optimum;
+	this->budget = budget;
+	nextTarget = 0;
+	std::fill(hits.begin(), hits.end(), 0);
+}
+
+void PerformanceAggregator::observe(int const evaluations, double const bestSoFar){
+	double const precision = bestSoFar - optimum;
+	while (nextTarget < (int)targets.size() && precision <= targets[nextTarget]){
+		hits[nextTarget] = evaluations;
+		nextTarget++;
+	}
+}
+
+void PerformanceAggregator::endRun(int const evaluations){
+	std::lock_guard<std::mutex> lock(mutex);
+	Cell& cell = cells[std::make_pair(function, D)];
+	if (cell.runs == 0){
+		cell.evaluations.resize(targets.size(), 0.);
+		cell.successes.resize(targets.size(), 0);
+	}
+
+	// Area under the ECDF over log(evaluations), normalized to [0,1] by the budget
+	double const logBudget = std::log(std::max(2, std::max(budget, evaluations)));
+	double area = 0.;
+	for (int t = 0; t < (int)targets.size(); t++){
+		if (t < nextTarget){
+			cell.evaluations[t] += hits[t];
+			cell.successes[t]++;
+			area += 1. - std::log(std::max(1, hits[t])) / logBudget;
+		} else
+			cell.evaluations[t] += evaluations;
+	}
+
+	cell.area += area / targets.size();
+	cell.runs++;
+}
+
+double PerformanceAggregator::ert(int const function, int const D, int const target){
+	std::lock_guard<std::mutex> lock(mutex);
+	Cell const& cell = cells.at(std::make_pair(function, D));
+	if (cell.successes[target] == 0)
+		return std::numeric_limits<double>::infinity();
+	return cell.evaluations[target] / cell.successes[target];
+}
+
+double PerformanceAggregator::ecdfArea(int const function, int const D){
+	std::lock_guard<std::mutex> lock(mutex);
+	Cell const& cell = cells.at(std::make_pair(function, D));
+	return cell.area / cell.runs;
+}
+
+void PerformanceAggregator::write(LogSink* const sink){
+	std::lock_guard<std::mutex> lock(mutex);
+	std::ostringstream out;
+	out << "# " << config << " targets:";
+	for (double t : targets)
+		out << " " << t;
+	out << "\n# function D runs area ert... successes...\n";
+
+	for (auto const& c : cells){
+		Cell const& cell = c.second;
+		out << c.first.first << " " << c.first.second << " " << cell.runs << " " << cell.area / cell.runs;
+		for (int t = 0; t < (int)targets.size(); t++){
+			if (cell.successes[t] == 0)
+				out << " inf";
+			else
+				out << " " << cell.evaluations[t] / cell.successes[t];
+		}
+		for (int s : cell.successes)
+			out << " " << s;
+		out << "\n";
+	}
+	sink->write(out.str());
+}
+
+// Line: function D runs area evaluations[targets] successes[targets]
+void PerformanceAggregator::save(std::string const filename){
+	std::lock_guard<std::mutex> lock(mutex);
+	std::ostringstream out;
+	out.precision(17);
+	out << "# " << config << " targets: " << targets.size() << "\n";
+	for (auto const& c : cells){
+		Cell const& cell = c.second;
+		out << c.first.first << " " << c.first.second << " " << cell.runs << " " << cell.area;
+		for (double e : cell.evaluations)
+			out << " " << e;
+		for (int s : cell.successes)
+			out << " " << s;
+		out << "\n";
+	}
+
+	std::ofstream file(filename + ".tmp", std::ios::trunc);
+	file << out.str();
+	file.close();
+	if (!file || std::rename((filename + ".tmp").c_str(), filename.c_str()) != 0)
+		std::cerr << "Cannot write " << filename << std::endl;
+}
+
+void PerformanceAggregator::load(std::string const filename){
+	std::ifstream in(filename);
+	std::string line;
+	if (!std::getline(in, line))
+		return;
+	std::size_t const split = line.find("targets: ");
+	if (split == std::string::npos || std::stoul(line.substr(split + 9)) != targets.size()){
+		std::cerr << "Ignoring " << filename << ", its targets differ" << std::endl;
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	while (std::getline(in, line)){
+		std::istringstream values(line);
+		int f, d, runs;
+		double area;
+		std::vector<double> evaluations(targets.size());
+		std::vector<int> successes(targets.size());
+		values >> f >> d >> runs >> area;
+		for (double& e : evaluations)
+			values >> e;
+		for (int& s : successes)
+			values >> s;
+		if (!values)
+			continue;
+
+		Cell& cell = cells[std::make_pair(f, d)];
+		if (cell.runs == 0){
+			cell.evaluations.resize(targets.size(), 0.);
+			cell.successes.resize(targets.size(), 0);
+		}
+		cell.runs += runs;
+		cell.area += area;
+		for (int t = 0; t < (int)targets.size(); t++){
+			cell.evaluations[t] += evaluations[t];
+			cell.successes[t] += successes[t];
+		}
+	}
+}
@@ -11,6 +11,8 @@
 #include "mutationmanager.h"
 #include "psode2.h"
 #include "deadaptationmanager.h"
+#include "livefeed.h"
+#include "runarchive.h"
 #include <limits>
 #include <iostream>
 #include <algorithm> 
@@ -37,8 +39,10 @@ void PSODE2::runAsynchronous(std::shared_ptr<IOHprofiler_problem<double> > probl
 
 	DEConstraintHandler *const deCH = deCHs.at(config.deCH)(lowerBound,upperBound);
 	PSOConstraintHandler *const psoCH = psoCHs.at(config.psoCH)(lowerBound,upperBound);
-	ParticleUpdateSettings const settings(config.update, particleUpdateParams, psoCH);
+	ParticleUpdateManager* const updateManager = updateManagers.at(config.update)(D, particleUpdateParams);
+	ParticleUpdateSettings const settings(updateManager, psoCH);
 
+	EvaluationBuffer evaluations(problem, logSettings.csv ? logger : nullptr, logSettings.aggregator, evalBudget, evaluationSettings);
 	int const split = popSize / 2;
 	for (int i = 0; i < split; i++) psoPop.push_back(new Particle(D, &settings));
 	for (int i = split; i < popSize; i++) dePop.push_back(new Solution(D));
@@ -47,19 +51,20 @@ void PSODE2::runAsynchronous(std::shared_ptr<IOHprofiler_problem<double> > probl
 
 	for (Solution* const p : particles){
 		p->randomize(lowerBound, upperBound);
-		p->evaluate(problem, logger);
+		p->evaluate(evaluations);
 	}
 
-	TopologyManager* const topologyManager = topologies.at(config.topology)(psoPop);
+	TopologyManager* const topologyManager = topologies.at(config.topology)(psoPop, particleUpdateParams);
 	MutationManager* const mutationManager = mutations.at(config.mutation)(D, deCH);
 	CrossoverManager const*const crossoverManager = crossovers.at(config.crossover)(D);
 	DEAdaptationManager *const adaptationManager = deAdaptations.at(config.adaptation)(popSize);
 
 	std::vector<double> Fs(dePop.size());
 	std::vector<double> Crs(dePop.size());
+	LiveFeedWriter liveFeed(logSettings.liveFeed, popSize, D, problem->IOHprofiler_get_problem_id());
 
 	int iterations = 0;
-	while (problem->IOHprofiler_get_evaluations() < evalBudget &&
+	while (evaluations.getSpent() < evalBudget &&
 			!problem->IOHprofiler_hit_optimal()){
 
 		// Get new DE parameters from the adaptation manager (JADE or constant)
@@ -72,8 +77,8 @@ void PSODE2::runAsynchronous(std::shared_ptr<IOHprofiler_problem<double> > probl
 		for (Particle* const p : psoPop){
 			p->updatePbest();
 			p->updateGbest();
-			p->updateVelocityAndPosition(double(problem->IOHprofiler_get_evaluations())/double(evalBudget));			
-			p->evaluate(problem,logger);
+			p->updateVelocityAndPosition(double(evaluations.getSpent())/double(evalBudget));			
+			p->evaluate(evaluations);
 		}
 
 		// Perform mutation 
@@ -87,10 +92,10 @@ void PSODE2::runAsynchronous(std::shared_ptr<IOHprofiler_problem<double> > probl
 		std::vector<double> parentF(popSize), trialF(popSize);
 		for (unsigned int i = 0; i < dePop.size(); i++){
 			//Evaluate the parent vector
-			parentF[i] = dePop[i]->evaluate(problem,logger);
+			parentF[i] = dePop[i]->evaluate(evaluations);
 
 			//Evaluate the trial vector
-			trialF[i] = trials[i]->evaluate(problem,logger);
+			trialF[i] = trials[i]->evaluate(evaluations);
 
 			// Perform selection
 			if ( trialF[i] < parentF[i] ){
@@ -106,15 +111,41 @@ void PSODE2::runAsynchronous(std::shared_ptr<IOHprofiler_problem<double> > probl
 
 		adaptationManager->update(parentF, trialF);
 		iterations++;	
-		topologyManager->update(double(problem->IOHprofiler_get_evaluations())/evalBudget);	
+		topologyManager->update(double(evaluations.getSpent())/evalBudget);	
+		evaluations.flush();
+		liveFeed.publish(particles);
 	}
 
 	delete topologyManager;
 	delete mutationManager;
 	delete crossoverManager;
 	delete adaptationManager;
+
+	if (logSettings.archive != NULL){ // Particles stand for their personal best
+		std::vector<double> bestX = dePop[0]->getX();
+		double bestF = dePop[0]->getFitness();
+		for (Solution const* const s : dePop)
+			if (s->getFitness() < bestF){
+				bestX = s->getX();
+				bestF = s->getFitness();
+			}
+		for (Particle const* const p : psoPop)
+			if (p->getPbest() < bestF){
+				bestX = p->getP();
+				bestF = p->getPbest();
+			}
+		int const evaluations = problem->IOHprofiler_get_evaluations();
+		double const perc = double(deCH->getCorrections() + psoCH->getCorrections()) / evaluations;
+		logSettings.archive->add(RunRecord{getIdString(), problem->IOHprofiler_get_problem_id(), D,
+			std::vector<double>(3, perc), bestX, bestF, evaluations});
+	}
+	if (evaluationSettings.counters != NULL){
+		evaluationSettings.counters->addResamples(deCH->getResampleHistogram());
+		evaluationSettings.counters->addResamples(psoCH->getResampleHistogram());
+	}
 	delete deCH;
 	delete psoCH;
+	delete updateManager;
 
 	for (Solution* particle : particles)
 		delete particle;
@@ -0,0 +1,120 @@
+#include "resultindex.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+// Aggregate queries over the results of a sweep.
+// Usage: pso-de-query [options] <summary|rank|wins> <file or directory>...
+static void usage(char const* const name){
+	std::cerr << "Usage: " << name << " [options] <summary|rank|wins> <file or directory>..." << std::endl
+		<< "  summary  best and median fitness per configuration, function and dimension" << std::endl
+		<< "  rank     rank of the median fitness per function and dimension, and mean rank per configuration" << std::endl
+		<< "  wins     number of functions and dimensions on which a configuration has the best median" << std::endl
+		<< "Options:" << std::endl
+		<< "  -i <file>    index file (default pso-de-query.idx)" << std::endl
+		<< "  -t <n>       threads (default: all)" << std::endl
+		<< "  -c <text>    only configurations containing text" << std::endl
+		<< "  -f <id>      only this function" << std::endl
+		<< "  -d <D>       only this dimension" << std::endl;
+}
+
+struct ConfigScore {
+	int config;
+	int cells;
+	double rankSum;
+	int wins;
+};
+
+int main(int argc, char** argv){
+	std::string indexFile = "pso-de-query.idx";
+	std::string configFilter;
+	int threads = 0, function = -1, D = -1;
+
+	int arg = 1;
+	for (; arg < argc && argv[arg][0] == '-'; arg += 2){
+		if (arg + 1 >= argc){
+			usage(argv[0]);
+			return 1;
+		}
+		std::string const option = argv[arg], value = argv[arg+1];
+		if (option == "-i")
+			indexFile = value;
+		else if (option == "-t")
+			threads = std::stoi(value);
+		else if (option == "-c")
+			configFilter = value;
+		else if (option == "-f")
+			function = std::stoi(value);
+		else if (option == "-d")
+			D = std::stoi(value);
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (argc - arg < 2){
+		usage(argv[0]);
+		return 1;
+	}
+	std::string const query = argv[arg++];
+	if (query != "summary" && query != "rank" && query != "wins"){
+		usage(argv[0]);
+		return 1;
+	}
+
+	auto const start = std::chrono::steady_clock::now();
+	ResultIndex index;
+	index.load(indexFile);
+	int const parsed = index.update(std::vector<std::string>(argv + arg, argv + argc), threads);
+	if (parsed > 0)
+		index.save(indexFile);
+
+	std::vector<std::string> const& configs = index.getConfigs();
+	std::vector<bool> configSelected(configs.size());
+	for (std::size_t c = 0; c < configs.size(); c++)
+		configSelected[c] = configs[c].find(configFilter) != std::string::npos;
+
+	std::vector<ResultGroup> const groups = index.groups([&](ResultRow const& r){
+		return configSelected[r.config] && (function < 0 || r.function == function) && (D < 0 || r.D == D);
+	}, threads);
+
+	if (query == "summary"){
+		std::cout << "config\tfunction\tD\truns\tbest\tmedian\trank" << std::endl;
+		for (ResultGroup const& g : groups)
+			std::cout << configs[g.config] << "\t" << g.function << "\t" << g.D << "\t" << g.runs << "\t"
+				<< g.best << "\t" << g.median << "\t" << g.rank << std::endl;
+	} else {
+		std::map<int, ConfigScore> scores;
+		for (ResultGroup const& g : groups){
+			ConfigScore& s = scores.insert(std::make_pair(g.config, ConfigScore{g.config, 0, 0., 0})).first->second;
+			s.cells++;
+			s.rankSum += g.rank;
+			s.wins += g.win;
+		}
+		std::vector<ConfigScore> table;
+		for (auto const& s : scores)
+			table.push_back(s.second);
+
+		if (query == "rank"){
+			std::sort(table.begin(), table.end(), [](ConfigScore const& a, ConfigScore const& b){
+				return a.rankSum / a.cells < b.rankSum / b.cells; });
+			std::cout << "config\tcells\tmeanRank" << std::endl;
+			for (ConfigScore const& s : table)
+				std::cout << configs[s.config] << "\t" << s.cells << "\t" << s.rankSum / s.cells << std::endl;
+		} else {
+			std::sort(table.begin(), table.end(), [](ConfigScore const& a, ConfigScore const& b){
+				return a.wins > b.wins; });
+			std::cout << "config\tcells\twins" << std::endl;
+			for (ConfigScore const& s : table)
+				std::cout << configs[s.config] << "\t" << s.cells << "\t" << s.wins << std::endl;
+		}
+	}
+
+	std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+	std::cerr << index.getRows().size() << " runs of " << configs.size() << " configurations, "
+		<< parsed << " files parsed, " << elapsed.count() << "s" << std::endl;
+	return 0;
+}
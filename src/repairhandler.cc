@@ -2,6 +2,7 @@
 #include "particle.h"
 #include "util.h"
 #include <algorithm>
+#include <cmath>
 #include <exception>
 #include <limits>
 
@@ -10,20 +11,31 @@ void PSOConstraintHandler::repairVelocityPost(Particle* const p, int const i){
 	p->setV(i, 0.);
 }
 
+double* PSOConstraintHandler::velocity(Particle* const p){
+	return p->v.data();
+}
+
+HyperbolicRepair::HyperbolicRepair(std::vector<double> const lb, std::vector<double> const ub)
+	:ConstraintHandler(lb,ub), PSOConstraintHandler(lb, ub), center(D){
+	for (int i = 0; i < D; i++)
+		center[i] = (lb[i] + ub[i])/2.;
+}
+
+// Every dimension is scaled, towards the bound the velocity is compared with
 void HyperbolicRepair::repairVelocityPre(Particle * const p) {
-	bool repaired = false;
+	double const* const x = position(p);
+	double* const v = velocity(p);
+	double const* const l = lb.data();
+	double const* const u = ub.data();
+	double const* const c = center.data();
+	#pragma omp simd
 	for (int i = 0; i < D; i++){
-		double const center = (lb[i] + ub[i])/2.;
-		double const v = p->getV(i);
-		if (v > center){
-			p->setV(i, v / (1. + std::abs(v / (ub[i] - p->getX(i)))));
-			repaired=true;
-		} else {
-			p->setV(i, v / (1. + std::abs(v / (p->getX(i) - lb[i]))));
-			repaired=true;
-		}
+		double const vi = v[i], xi = x[i];
+		double const toUpper = u[i] - xi, toLower = xi - l[i];
+		double const room = vi > c[i] ? toUpper : toLower;
+		v[i] = vi / (1. + std::abs(vi / room));
 	}
-	if (repaired) nCorrected++;
+	if (D > 0) nCorrected++;
 }
 
 void PBestDimRepair::repairPSO(Particle* const p) {
@@ -151,14 +163,16 @@ void ConservatismRepair::repairDE(Solution* const p, Solution const*const base,
 // Generic
 bool ResamplingRepair::resample(Solution * const p, int const resamples) {
 	if (isFeasible(p)){
+		countResamples(resamples);
 		return false;
-	} else if (resamples >= 100){
+	} else if (resamples >= maxResamples){
 		for (int i = 0; i < D; i++){
 			if (p->getX(i) < lb[i])
 				p->setX(i, lb[i]);
 			else if (p->getX(i) > ub[i])
 				p->setX(i, ub[i]);
 		}
+		countResamples(resamples);
 		return false;
 	}
 
@@ -168,10 +182,16 @@ bool ResamplingRepair::resample(Solution * const p, int const resamples) {
 }
 
 void DeathPenalty::penalize(Solution* const p) {
-	if (!isFeasible(p)){
-		p->setFitness(std::numeric_limits<double>::max());
-		nCorrected++;
-	}
+	screen(p);
+}
+
+// The penalty does not depend on the fitness, so it can be given up front
+bool DeathPenalty::screen(Solution* const p) {
+	if (isFeasible(p))
+		return false;
+	p->setFitness(std::numeric_limits<double>::max());
+	nCorrected++;
+	return true;
 }
 
 // Reinitialization
@@ -199,104 +219,165 @@ void ReinitializationRepair::repair(Solution* const p) {
 	if (repaired) nCorrected++;
 }
 
+// The kernels below work on raw rows without branches: every dimension
+// computes its repaired value, which is selected where a bound is violated,
+// and zeroes its velocity there if the particle has one. Each returns the
+// number of violated dimensions. Every candidate value is computed before
+// it is selected and the violations are counted in a double, otherwise the
+// compiler keeps the branches.
+
 // Projection
-void ProjectionRepair::repair(Particle* const p) {
-	bool repaired = false;
+template <bool hasVelocity>
+static inline int projectionKernel(double* const x, double* const v, double const* const lb, double const* const ub, int const D){
+	double violated = 0;
+	#pragma omp simd reduction(+:violated)
 	for (int i = 0; i < D; i++){
-		if (p->getX(i) < lb[i]){
-			p->setX(i, lb[i]);
-			repairVelocityPost(p, i);
-			repaired = true;
-		} else if (p->getX(i) > ub[i]){
-			p->setX(i, ub[i]);
-			repairVelocityPost(p, i);
-			repaired = true;
-		}
+		double const xi = x[i], l = lb[i], u = ub[i];
+		double const vi = hasVelocity ? v[i] : 0.; // Loaded before x is stored, which it may alias
+		bool const low = xi < l;
+		bool const high = xi > u;
+		double y = low ? l : xi;
+		y = high ? u : y;
+		x[i] = y;
+		bool const out = low | high;
+		if (hasVelocity)
+			v[i] = out ? 0. : vi;
+		violated += out ? 1. : 0.;
 	}
-	if (repaired) nCorrected++;
+	return violated;
+}
+
+void ProjectionRepair::repair(Particle* const p) {
+	if (projectionKernel<true>(position(p), velocity(p), lb.data(), ub.data(), D) > 0)
+		nCorrected++;
 }
+
 void ProjectionRepair::repair(Solution* const p) {
-	bool repaired = false;
+	if (projectionKernel<false>(position(p), NULL, lb.data(), ub.data(), D) > 0)
+		nCorrected++;
+}
+
+// Qualified calls, so the kernel is inlined instead of dispatched per row
+void ProjectionRepair::repairAll(std::vector<Solution*> const& p) {
+	for (Solution* const s : p)
+		ProjectionRepair::repair(s);
+}
+
+void ProjectionRepair::repairAll(std::vector<Particle*> const& p) {
+	for (Particle* const q : p)
+		ProjectionRepair::repair(q);
+}
+
+// Reflection: one reflection brings back everything that overshot by less
+// than the width, anything further keeps reflecting in a scalar pass
+template <bool hasVelocity>
+static inline int reflectionKernel(double* const x, double* const v, double const* const lb, double const* const ub, int const D){
+	double violated = 0, outside = 0;
+	#pragma omp simd reduction(+:violated,outside)
 	for (int i = 0; i < D; i++){
-		if (p->getX(i) < lb[i]){
-			p->setX(i, lb[i]);
-			repaired=true;
-		} else if (p->getX(i) > ub[i]){
-			p->setX(i, ub[i]);
-			repaired=true;
-		}
+		double const xi = x[i], l = lb[i], u = ub[i];
+		double const vi = hasVelocity ? v[i] : 0.; // Loaded before x is stored, which it may alias
+		bool const low = xi < l;
+		bool const high = xi > u;
+		double const fromLow = 2. * l - xi, fromHigh = 2. * u - xi;
+		double y = low ? fromLow : xi;
+		y = high ? fromHigh : y;
+		x[i] = y;
+		bool const out = low | high;
+		if (hasVelocity)
+			v[i] = out ? 0. : vi;
+		violated += out ? 1. : 0.;
+		outside += (y < l) | (y > u) ? 1. : 0.;
 	}
-	if (repaired) nCorrected++;
+
+	if (outside > 0)
+		for (int i = 0; i < D; i++)
+			while (true){
+				if (x[i] < lb[i])
+					x[i] = 2. * lb[i] - x[i];
+				else if (x[i] > ub[i])
+					x[i] = 2. * ub[i] - x[i];
+				else
+					break;
+			}
+	return violated;
 }
 
-// Reflection
 void ReflectionRepair::repair(Particle* const p) {
-	bool repaired = false;
-	for (int i = 0; i < D; i++){
-		while (true){
-			if (p->getX(i) < lb[i]){
-				p->setX(i, 2. * lb[i] - p->getX(i));
-				repairVelocityPost(p,i);
-				repaired=true;
-			}
-			else if (p->getX(i) > ub[i]){
-				p->setX(i, 2. * ub[i] - p->getX(i));
-				repairVelocityPost(p,i);
-				repaired=true;
-			} else
-				break;
-		}
-	}
-	if (repaired) nCorrected++;
+	if (reflectionKernel<true>(position(p), velocity(p), lb.data(), ub.data(), D) > 0)
+		nCorrected++;
 }
 
 void ReflectionRepair::repair(Solution* const p) {
-	bool repaired = false;
+	if (reflectionKernel<false>(position(p), NULL, lb.data(), ub.data(), D) > 0)
+		nCorrected++;
+}
+
+void ReflectionRepair::repairAll(std::vector<Solution*> const& p) {
+	for (Solution* const s : p)
+		ReflectionRepair::repair(s);
+}
+
+void ReflectionRepair::repairAll(std::vector<Particle*> const& p) {
+	for (Particle* const q : p)
+		ReflectionRepair::repair(q);
+}
+
+// Wrapping: an overshot by less than the width wraps to the other bound as
+// it is, so fmod is only needed, in a scalar pass, for the rest
+WrappingRepair::WrappingRepair(std::vector<double> const lb, std::vector<double> const ub)
+	:ConstraintHandler(lb,ub), DEConstraintHandler(lb, ub), PSOConstraintHandler(lb,ub), width(D){
+	for (int i = 0; i < D; i++)
+		width[i] = std::abs(ub[i]-lb[i]);
+}
+
+template <bool hasVelocity>
+static inline int wrappingKernel(double* const x, double* const v, double const* const lb, double const* const ub,
+		double const* const width, int const D){
+	double violated = 0, far = 0;
+	#pragma omp simd reduction(+:violated,far)
 	for (int i = 0; i < D; i++){
-		while (true){
-			if (p->getX(i) < lb[i]){
-				p->setX(i, 2. * lb[i] - p->getX(i));
-				repaired=true;
-			}
-			else if (p->getX(i) > ub[i]){
-				p->setX(i, 2. * ub[i] - p->getX(i));
-				repaired=true;
-			} else
-				break;
-		}
+		double const xi = x[i], l = lb[i], u = ub[i];
+		double const vi = hasVelocity ? v[i] : 0.; // Loaded before x is stored, which it may alias
+		double const under = l - xi, over = xi - u;
+		double const overshot = xi < l ? under : over; // Negative inside
+		double const fromLow = u - overshot, fromHigh = l + overshot;
+		double const wrapped = xi < l ? fromLow : fromHigh;
+		x[i] = ((xi < l) | (xi > u)) & (overshot < width[i]) ? wrapped : xi;
+		if (hasVelocity)
+			v[i] = (xi < l) | (xi > u) ? 0. : vi;
+		violated += (xi < l) | (xi > u) ? 1. : 0.;
+		far += overshot < width[i] ? 0. : 1.;
 	}
-	if (repaired) nCorrected++;
+
+	if (far > 0)
+		for (int i = 0; i < D; i++){
+			if (x[i] < lb[i])
+				x[i] = ub[i] - std::fmod(lb[i] - x[i], width[i]);
+			else if (x[i] > ub[i])
+				x[i] = lb[i] + std::fmod(x[i] - ub[i], width[i]);
+		}
+	return violated;
 }
 
-// Wrapping
 void WrappingRepair::repair(Particle* const p) {
-	bool repaired = false;
-	for (int i = 0; i < D; i++){
-		if (p->getX(i) < lb[i]){
-			p->setX(i, ub[i] - std::fmod(lb[i] - p->getX(i), std::abs(ub[i]-lb[i])));
-			repairVelocityPost(p,i);
-			repaired=true;
-		} else if (p->getX(i) > ub[i]) {
-			p->setX(i, lb[i] + std::fmod(p->getX(i) - ub[i], std::abs(ub[i]-lb[i])));
-			repairVelocityPost(p,i);
-			repaired=true;
-		}
-	}
-	if (repaired) nCorrected++;
+	if (wrappingKernel<true>(position(p), velocity(p), lb.data(), ub.data(), width.data(), D) > 0)
+		nCorrected++;
 }
 
 void WrappingRepair::repair(Solution* const p) {
-	bool repaired = false;
-	for (int i = 0; i < D; i++){
-		if (p->getX(i) < lb[i]){
-			p->setX(i, ub[i] - std::fmod(lb[i] - p->getX(i), std::abs(ub[i]-lb[i])));
-			repaired=true;
-		} else if (p->getX(i) > ub[i]) {
-			p->setX(i, lb[i] + std::fmod(p->getX(i) - ub[i], std::abs(ub[i]-lb[i])));
-			repaired=true;
-		}
-	}
-	if (repaired) nCorrected++;
+	if (wrappingKernel<false>(position(p), NULL, lb.data(), ub.data(), width.data(), D) > 0)
+		nCorrected++;
+}
+
+void WrappingRepair::repairAll(std::vector<Solution*> const& p) {
+	for (Solution* const s : p)
+		WrappingRepair::repair(s);
+}
+
+void WrappingRepair::repairAll(std::vector<Particle*> const& p) {
+	for (Particle* const q : p)
+		WrappingRepair::repair(q);
 }
 
 // Transformation, adapted from https://github.com/psbiomech/c-cmaes
@@ -311,89 +392,73 @@ TransformationRepair::TransformationRepair(std::vector<double>const lb, std::vec
 	}
 }
 
-// TODO maybe repair velocity in shift as well?
-void TransformationRepair::repair(Particle* const p) {
-	bool repaired = shift(p);
-	for (int i = 0; i < D; i++){
-		double const x_i = p->getX(i);
-		if (x_i < lb[i] + al[i]){
-			p->setX(i, lb[i] + pow(x_i - (lb[i] - al[i]),2.)/(4.*al[i]));
-			repairVelocityPost(p,i);
-			repaired=true;
-		}
-		else if (x_i > ub[i]-au[i]){
-			p->setX(i, ub[i] - pow(x_i - (ub[i] + au[i]),2.)/(4.*au[i]));
-			repairVelocityPost(p,i);
-			repaired=true;
-		}
-	}
-	if (repaired) nCorrected++;
+// Mirrors y into [lb - a, ub + b] and bends the values within a and b of
+// the bounds onto a parabola, with a single division for either side
+static inline double fold(double y, double const lb, double const ub, double const a, double const b){
+	double const l = lb - a, u = ub + b;
+	double const mirroredLow = y + 2. * (l - y);
+	y = y < l ? mirroredLow : y;
+	double const mirroredHigh = y - 2. * (y - ub - b);
+	y = y > u ? mirroredHigh : y;
+
+	bool const low = y < lb + a;
+	double const d = low ? y - l : y - u;
+	double const bent = (low ? d * d : -(d * d)) / (low ? 4. * a : 4. * b);
+	double const folded = (low ? lb : ub) + bent;
+	return low | (y > ub - b) ? folded : y;
 }
 
-bool TransformationRepair::shift(Particle* const p) {
-	bool repaired = false;
+// Values inside [xlo, xhi] are folded in one pass, the rest are first
+// shifted there by whole periods r in a scalar pass
+template <bool hasVelocity>
+int TransformationRepair::transform(double* const x, double* const v) const {
+	double const* const a = al.data();
+	double const* const b = au.data();
+	double const* const lo = xlo.data();
+	double const* const hi = xhi.data();
+	double violated = 0, far = 0;
+	#pragma omp simd reduction(+:violated,far)
 	for (int i = 0; i < D; i++){
-		if (p->getX(i) < xlo[i]) {
-			p->setX(i, p->getX(i) + r[i] * (1 + (int)((xlo[i] - p->getX(i))/r[i])) );
-			repairVelocityPost(p,i);
-			repaired=true;
-		}
-		if (p->getX(i) > xhi[i]) {
-			p->setX(i, p->getX(i) - r[i] * (1 + (int)((p->getX(i)-xhi[i])/r[i])) );
-			repairVelocityPost(p,i);
-			repaired=true;
-		}
+		double const xi = x[i];
+		double const vi = hasVelocity ? v[i] : 0.;
+		double const folded = fold(xi, lb[i], ub[i], a[i], b[i]);
+		x[i] = (xi < lo[i]) | (xi > hi[i]) ? xi : folded;
+		double const repaired = (xi < lb[i] + a[i]) | (xi > ub[i] - b[i]) ? 1. : 0.;
+		if (hasVelocity)
+			v[i] = repaired > 0. ? 0. : vi;
+		violated += repaired;
+		far += (xi < lo[i]) | (xi > hi[i]) ? 1. : 0.;
+	}
 
-		if (p->getX(i) < lb[i] - al[i]) {
-			p->setX(i, p->getX(i) + 2. * (lb[i] - al[i] - p->getX(i)));
-			repairVelocityPost(p,i);
-			repaired=true;
-		}
-		if (p->getX(i) > ub[i] + au[i]){
-			p->setX(i, p->getX(i) - 2. * (p->getX(i) - ub[i] - au[i]));
-			repairVelocityPost(p,i);
-			repaired=true;
+	if (far > 0)
+		for (int i = 0; i < D; i++){
+			if (x[i] < xlo[i])
+				x[i] += r[i] * (1 + (int)((xlo[i] - x[i]) / r[i]));
+			else if (x[i] > xhi[i])
+				x[i] -= r[i] * (1 + (int)((x[i] - xhi[i]) / r[i]));
+			else
+				continue;
+			x[i] = fold(x[i], lb[i], ub[i], a[i], b[i]);
 		}
-	}
-	return repaired;
+	return violated;
+}
+
+void TransformationRepair::repair(Particle* const p) {
+	if (transform<true>(position(p), velocity(p)) > 0)
+		nCorrected++;
 }
 
 void TransformationRepair::repair(Solution* const p) {
-	bool repaired = shift(p);
-	for (int i = 0; i < D; i++){
-		double const x_i = p->getX(i);
-		if (x_i < lb[i] + al[i]){
-			p->setX(i, lb[i] + pow(x_i - (lb[i] - al[i]),2.)/(4.*al[i]));
-			repaired=true;
-		}
-		else if (x_i > ub[i]-au[i]){
-			p->setX(i, ub[i] - pow(x_i - (ub[i] + au[i]),2.)/(4.*au[i]));
-			repaired=true;
-		}
-	}
-	if (repaired) nCorrected++;
+	if (transform<false>(position(p), NULL) > 0)
+		nCorrected++;
 }
 
-bool TransformationRepair::shift(Solution* const p){
-	bool repaired = false;
-	for (int i = 0; i < D; i++){
-		if (p->getX(i) < xlo[i]) {
-			p->setX(i, p->getX(i) + r[i] * (1 + (int)((xlo[i] - p->getX(i))/r[i])));
-			repaired=true;
-		}
-		if (p->getX(i) > xhi[i]){
-			p->setX(i, p->getX(i) - r[i] * (1 + (int)((p->getX(i)-xhi[i])/r[i])));
-			repaired=true;
-		}
+void TransformationRepair::repairAll(std::vector<Solution*> const& p) {
+	for (Solution* const s : p)
+		TransformationRepair::repair(s);
+}
 
-		if (p->getX(i) < lb[i] - al[i]){
-			p->setX(i, p->getX(i) + 2. * (lb[i] - al[i] - p->getX(i)));
-			repaired=true;
-		}
-		if (p->getX(i) > ub[i] + au[i]){
-			p->setX(i, p->getX(i) - 2. * (p->getX(i) - ub[i] - au[i]));
-			repaired=true;
-		}
-	}
-	return repaired;
+void TransformationRepair::repairAll(std::vector<Particle*> const& p) {
+	for (Particle* const q : p)
+		TransformationRepair::repair(q);
 }
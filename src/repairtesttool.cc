@@ -0,0 +1,270 @@
+#include "repairhandler.h"
+#include "particle.h"
+#include "particleupdatesettings.h"
+#include "rng.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// Checks the branch-free repair kernels against the scalar loops they replaced.
+// Usage: pso-de-repairtest [rows]
+// Rows are drawn inside the bounds, just outside them and many widths outside them.
+
+/*		Scalar references 		*/
+typedef std::vector<double> Row;
+
+struct Bounds {
+	Row lb, ub;
+};
+
+// Velocity of a repaired dimension, as PSOConstraintHandler::repairVelocityPost
+static void stop(Row* const v, int const i){
+	if (v)
+		(*v)[i] = 0.;
+}
+
+static bool projection(Bounds const& b, Row& x, Row* const v){
+	bool repaired = false;
+	for (unsigned int i = 0; i < x.size(); i++){
+		if (x[i] < b.lb[i]){
+			x[i] = b.lb[i];
+			stop(v, i);
+			repaired = true;
+		} else if (x[i] > b.ub[i]){
+			x[i] = b.ub[i];
+			stop(v, i);
+			repaired = true;
+		}
+	}
+	return repaired;
+}
+
+static bool reflection(Bounds const& b, Row& x, Row* const v){
+	bool repaired = false;
+	for (unsigned int i = 0; i < x.size(); i++){
+		while (true){
+			if (x[i] < b.lb[i])
+				x[i] = 2. * b.lb[i] - x[i];
+			else if (x[i] > b.ub[i])
+				x[i] = 2. * b.ub[i] - x[i];
+			else
+				break;
+			stop(v, i);
+			repaired = true;
+		}
+	}
+	return repaired;
+}
+
+static bool wrapping(Bounds const& b, Row& x, Row* const v){
+	bool repaired = false;
+	for (unsigned int i = 0; i < x.size(); i++){
+		if (x[i] < b.lb[i]){
+			x[i] = b.ub[i] - std::fmod(b.lb[i] - x[i], std::abs(b.ub[i] - b.lb[i]));
+			stop(v, i);
+			repaired = true;
+		} else if (x[i] > b.ub[i]){
+			x[i] = b.lb[i] + std::fmod(x[i] - b.ub[i], std::abs(b.ub[i] - b.lb[i]));
+			stop(v, i);
+			repaired = true;
+		}
+	}
+	return repaired;
+}
+
+static bool transformation(Bounds const& b, Row& x, Row* const v){
+	bool repaired = false;
+	for (unsigned int i = 0; i < x.size(); i++){
+		double const lb = b.lb[i], ub = b.ub[i];
+		double const al = std::min((ub - lb)/2., (1. + std::abs(lb))/20.);
+		double const au = std::min((ub - lb)/2., (1. + std::abs(ub))/20.);
+		double const xlo = lb - 2. * al - (ub - lb) / 2.;
+		double const xhi = ub + 2. * au + (ub - lb) / 2.;
+		double const r = 2. * (ub - lb + al + au);
+
+		// Shift into one period
+		if (x[i] < xlo){
+			x[i] = x[i] + r * (1 + (int)((xlo - x[i])/r));
+			stop(v, i);
+			repaired = true;
+		}
+		if (x[i] > xhi){
+			x[i] = x[i] - r * (1 + (int)((x[i] - xhi)/r));
+			stop(v, i);
+			repaired = true;
+		}
+		if (x[i] < lb - al){
+			x[i] = x[i] + 2. * (lb - al - x[i]);
+			stop(v, i);
+			repaired = true;
+		}
+		if (x[i] > ub + au){
+			x[i] = x[i] - 2. * (x[i] - ub - au);
+			stop(v, i);
+			repaired = true;
+		}
+	}
+	for (unsigned int i = 0; i < x.size(); i++){
+		double const lb = b.lb[i], ub = b.ub[i];
+		double const al = std::min((ub - lb)/2., (1. + std::abs(lb))/20.);
+		double const au = std::min((ub - lb)/2., (1. + std::abs(ub))/20.);
+
+		// Bend near the bounds
+		double const x_i = x[i];
+		if (x_i < lb + al){
+			x[i] = lb + std::pow(x_i - (lb - al), 2.)/(4. * al);
+			stop(v, i);
+			repaired = true;
+		} else if (x_i > ub - au){
+			x[i] = ub - std::pow(x_i - (ub + au), 2.)/(4. * au);
+			stop(v, i);
+			repaired = true;
+		}
+	}
+	return repaired;
+}
+
+static bool hyperbolic(Bounds const& b, Row const& x, Row& v){
+	for (unsigned int i = 0; i < x.size(); i++){
+		double const center = (b.lb[i] + b.ub[i])/2.;
+		if (v[i] > center)
+			v[i] = v[i] / (1. + std::abs(v[i] / (b.ub[i] - x[i])));
+		else
+			v[i] = v[i] / (1. + std::abs(v[i] / (x[i] - b.lb[i])));
+	}
+	return true;
+}
+
+/*		Inputs 		*/
+static Bounds randomBounds(int const D){
+	Bounds b{Row(D), Row(D)};
+	for (int i = 0; i < D; i++){
+		b.lb[i] = rng.randDouble(-10., 5.);
+		b.ub[i] = b.lb[i] + rng.randDouble(0.01, 20.);
+	}
+	return b;
+}
+
+// Position in widths from the lower bound
+static double randomX(Bounds const& b, int const i){
+	double const w = b.ub[i] - b.lb[i];
+	switch (rng.randInt(0, 5)){
+		case 0: return b.lb[i] + w * rng.randDouble(0., 1.); // Inside
+		case 1: return b.lb[i] - w * rng.randDouble(0., 1.); // Less than a width below
+		case 2: return b.ub[i] + w * rng.randDouble(0., 1.); // Less than a width above
+		case 3: return b.lb[i] - w * rng.randDouble(1., 1000.); // Far below
+		case 4: return b.ub[i] + w * rng.randDouble(1., 1000.); // Far above
+		default: return rng.randInt(0, 1) ? b.lb[i] : b.ub[i]; // On a bound
+	}
+}
+
+static bool same(Row const& a, Row const& b){
+	return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+/*		Checks 		*/
+typedef bool (*Reference)(Bounds const&, Row&, Row* const);
+
+// Repairs the same rows one by one and as a whole population, with and without velocity
+static int check(std::string const name, Reference const reference, int const rows){
+	int failures = 0;
+	for (int D : {1, 2, 3, 7, 16, 33}){
+		Bounds const b = randomBounds(D);
+		DEConstraintHandler* const deCH = deCHs.at(name)(b.lb, b.ub);
+		PSOConstraintHandler* const psoCH = psoCHs.at(name)(b.lb, b.ub);
+		ParticleUpdateSettings const settings(NULL, psoCH);
+
+		std::vector<Solution*> solutions, solutionsAll;
+		std::vector<Particle*> particles, particlesAll;
+		std::vector<Row> expectedX(rows), expectedXV(rows), expectedV(rows);
+		int corrected = 0;
+		for (int k = 0; k < rows; k++){
+			Row x(D), v(D);
+			for (int i = 0; i < D; i++){
+				x[i] = randomX(b, i);
+				v[i] = rng.randDouble(-20., 20.);
+			}
+			solutions.push_back(new Solution(x));
+			solutionsAll.push_back(new Solution(x));
+			particles.push_back(new Particle(D, &settings));
+			particles.back()->setX(x);
+			particles.back()->setV(v);
+			particlesAll.push_back(new Particle(*particles.back()));
+
+			expectedX[k] = x;
+			corrected += reference(b, expectedX[k], NULL);
+			expectedXV[k] = x;
+			expectedV[k] = v;
+			reference(b, expectedXV[k], &expectedV[k]);
+		}
+
+		for (int k = 0; k < rows; k++){
+			deCH->repair(solutions[k]);
+			psoCH->repair(particles[k]);
+		}
+		deCH->repairAll(solutionsAll);
+		psoCH->repairAll(particlesAll);
+
+		int mismatches = 0;
+		for (int k = 0; k < rows; k++){
+			mismatches += !same(solutions[k]->getX(), expectedX[k]) + !same(solutionsAll[k]->getX(), expectedX[k]);
+			mismatches += !same(particles[k]->getX(), expectedXV[k]) + !same(particles[k]->getV(), expectedV[k]);
+			mismatches += !same(particlesAll[k]->getX(), expectedXV[k]) + !same(particlesAll[k]->getV(), expectedV[k]);
+		}
+		if (deCH->getCorrections() != 2 * corrected || psoCH->getCorrections() != 2 * corrected)
+			mismatches++;
+		if (mismatches > 0)
+			std::cerr << name << " D=" << D << ": " << mismatches << " mismatches" << std::endl;
+		failures += mismatches;
+
+		for (int k = 0; k < rows; k++){
+			delete solutions[k];
+			delete solutionsAll[k];
+			delete particles[k];
+			delete particlesAll[k];
+		}
+		delete deCH;
+		delete psoCH;
+	}
+	std::cerr << name << (failures > 0 ? " FAILED" : " ok") << std::endl;
+	return failures;
+}
+
+static int checkHyperbolic(int const rows){
+	int failures = 0;
+	for (int D : {1, 2, 3, 7, 16, 33}){
+		Bounds const b = randomBounds(D);
+		PSOConstraintHandler* const psoCH = psoCHs.at("HY")(b.lb, b.ub);
+		ParticleUpdateSettings const settings(NULL, psoCH);
+		for (int k = 0; k < rows; k++){
+			Row x(D), v(D);
+			for (int i = 0; i < D; i++){
+				x[i] = b.lb[i] + (b.ub[i] - b.lb[i]) * rng.randDouble(0., 1.); // The velocity is fixed before leaving the bounds
+				v[i] = rng.randDouble(-1000., 1000.);
+			}
+			Particle p(D, &settings);
+			p.setX(x);
+			p.setV(v);
+			psoCH->repairVelocityPre(&p);
+			hyperbolic(b, x, v);
+			failures += !same(p.getV(), v);
+		}
+		failures += psoCH->getCorrections() != rows;
+		delete psoCH;
+	}
+	std::cerr << "HY" << (failures > 0 ? " FAILED" : " ok") << std::endl;
+	return failures;
+}
+
+int main(int argc, char** argv){
+	int const rows = argc > 1 ? std::stoi(argv[1]) : 2000;
+	rng.seed(42);
+
+	int failures = 0;
+	failures += check("PR", projection, rows);
+	failures += check("RF", reflection, rows);
+	failures += check("WR", wrapping, rows);
+	failures += check("TR", transformation, rows);
+	failures += checkHyperbolic(rows);
+	return failures > 0 ? 1 : 0;
+}
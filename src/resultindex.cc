@@ -0,0 +1,365 @@
+#include "resultindex.h"
+#include "runarchive.h"
+#include "parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <tuple>
+#include <stdexcept>
+#include <experimental/filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::experimental::filesystem;
+
+constexpr char INDEX_MAGIC[8] = {'P','S','O','D','E','I','D','X'};
+constexpr uint32_t INDEX_VERSION = 2; // Indexes of version 1 dropped rows with more than 3 correction rates
+
+/*		Parsing 		*/
+class MappedFile {
+	private:
+		int fd;
+		char const* data;
+		std::size_t length;
+	public:
+		MappedFile(std::string const filename): fd(-1), data(NULL), length(0){
+			fd = open(filename.c_str(), O_RDONLY);
+			if (fd < 0)
+				throw std::runtime_error("Cannot open " + filename);
+			struct stat st;
+			if (fstat(fd, &st) == 0)
+				length = st.st_size;
+			if (length == 0)
+				return;
+			void* const mapped = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped == MAP_FAILED){
+				close(fd);
+				throw std::runtime_error("Cannot map " + filename);
+			}
+			data = static_cast<char const*>(mapped);
+		}
+		~MappedFile(){
+			if (data != NULL)
+				munmap(const_cast<char*>(data), length);
+			close(fd);
+		}
+		MappedFile(MappedFile const&) = delete;
+		MappedFile& operator=(MappedFile const&) = delete;
+
+		template <typename F>
+		void lines(F f) const { // Calls f(begin, end) for every line
+			char const* p = data;
+			char const* const end = data + length;
+			while (p < end){
+				char const* eol = static_cast<char const*>(std::memchr(p, '\n', end - p));
+				if (eol == NULL)
+					eol = end;
+				f(p, eol);
+				p = eol + 1;
+			}
+		}
+};
+
+static void parseDoubles(char const* p, char const* const end, std::vector<double>& values){
+	values.clear();
+	while (true){
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+			p++;
+		if (p == end)
+			return;
+		double v;
+		std::from_chars_result const result = std::from_chars(p, end, v);
+		if (result.ec != std::errc()){
+			values.clear(); // Not a numeric row
+			return;
+		}
+		values.push_back(v);
+		p = result.ptr;
+	}
+}
+
+// scratch/extra_data/<config>.dat, see parseExtraData
+static void parseLegacy(MappedFile const& file, std::vector<ResultRow>& rows){
+	std::vector<double> values;
+	file.lines([&](char const* begin, char const* end){
+		parseDoubles(begin, end, values);
+		if (extraDataRates(values) < 0)
+			return;
+		rows.push_back(ResultRow{0, int32_t(values[0]), int32_t(values[1]), int32_t(values.back()), values[values.size()-2]});
+	});
+}
+
+// <config>/data_f<F>_<name>/IOHprofiler_f<F>_DIM<D>.dat: a quoted header line
+// starts every run, the last row of a run holds its best-so-far f(x)
+static void parseIOH(MappedFile const& file, int const function, int const D, std::vector<ResultRow>& rows){
+	std::vector<double> values;
+	bool open = false;
+	ResultRow last{0, function, D, 0, 0.};
+	file.lines([&](char const* begin, char const* end){
+		if (begin < end && *begin == '"'){
+			if (open)
+				rows.push_back(last);
+			open = false;
+			return;
+		}
+		parseDoubles(begin, end, values);
+		if (values.size() < 3)
+			return;
+		last.evaluations = values[0];
+		last.bestF = values[2];
+		open = true;
+	});
+	if (open)
+		rows.push_back(last);
+}
+
+static bool isIOH(std::string const& path, int& function, int& D){
+	return std::sscanf(fs::path(path).filename().string().c_str(), "IOHprofiler_f%d_DIM%d.dat", &function, &D) == 2;
+}
+
+void ResultIndex::parse(Source& source){
+	source.configs.clear();
+	source.rows.clear();
+	fs::path const path(source.path);
+
+	if (path.extension() == ".arc"){
+		RunArchiveReader const archive(source.path);
+		source.configs = archive.getConfigs();
+		for (int c = 0; c < (int)source.configs.size(); c++)
+			for (int i : archive.rows(source.configs[c]))
+				source.rows.push_back(ResultRow{c, archive.getFunction(i), archive.getD(i), archive.getEvaluations(i), archive.getBestF(i)});
+		return;
+	}
+
+	MappedFile const file(source.path);
+	int function, D;
+	if (isIOH(source.path, function, D)){
+		source.configs.push_back(path.parent_path().parent_path().filename().string());
+		parseIOH(file, function, D, source.rows);
+	} else {
+		source.configs.push_back(path.stem().string());
+		parseLegacy(file, source.rows);
+	}
+}
+
+/*		Index 		*/
+template <typename T>
+static void put(std::ofstream& out, T const& value){
+	out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+static void put(std::ofstream& out, std::string const& s){
+	put(out, uint32_t(s.size()));
+	out.write(s.data(), s.size());
+}
+
+template <typename T>
+static void get(std::ifstream& in, T& value){
+	in.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+static void get(std::ifstream& in, std::string& s){
+	uint32_t size = 0;
+	get(in, size);
+	s.resize(in ? size : 0);
+	in.read(&s[0], s.size());
+}
+
+bool ResultIndex::load(std::string const filename){
+	std::ifstream in(filename, std::ios::binary);
+	char magic[8];
+	uint32_t version = 0, nSources = 0;
+	in.read(magic, 8);
+	get(in, version);
+	get(in, nSources);
+	if (!in || std::memcmp(magic, INDEX_MAGIC, 8) != 0 || version != INDEX_VERSION)
+		return false;
+
+	std::vector<Source> loaded(nSources);
+	for (Source& source : loaded){
+		uint32_t nConfigs = 0, nRows = 0;
+		get(in, source.path);
+		get(in, source.size);
+		get(in, source.mtime);
+		get(in, nConfigs);
+		source.configs.resize(in ? nConfigs : 0);
+		for (std::string& config : source.configs)
+			get(in, config);
+		get(in, nRows);
+		source.rows.resize(in ? nRows : 0);
+		in.read(reinterpret_cast<char*>(source.rows.data()), source.rows.size() * sizeof(ResultRow));
+		if (!in)
+			return false;
+	}
+	sources.swap(loaded);
+	return true;
+}
+
+void ResultIndex::save(std::string const filename) const {
+	std::string const tmp = filename + ".tmp"; // Renamed afterwards so an interrupted save keeps the old index
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		out.write(INDEX_MAGIC, 8);
+		put(out, INDEX_VERSION);
+		put(out, uint32_t(sources.size()));
+		for (Source const& source : sources){
+			put(out, source.path);
+			put(out, source.size);
+			put(out, source.mtime);
+			put(out, uint32_t(source.configs.size()));
+			for (std::string const& config : source.configs)
+				put(out, config);
+			put(out, uint32_t(source.rows.size()));
+			out.write(reinterpret_cast<char const*>(source.rows.data()), source.rows.size() * sizeof(ResultRow));
+		}
+		if (!out)
+			throw std::runtime_error("Cannot write index " + filename);
+	}
+	fs::rename(tmp, filename);
+}
+
+int ResultIndex::update(std::vector<std::string> const& paths, int const threads){
+	std::vector<std::string> files;
+	for (std::string const& p : paths){
+		if (fs::is_directory(p)){
+			for (fs::directory_entry const& e : fs::recursive_directory_iterator(p))
+				if (fs::is_regular_file(e.path()) && (e.path().extension() == ".dat" || e.path().extension() == ".arc"))
+					files.push_back(e.path().string());
+		} else if (fs::exists(p))
+			files.push_back(p);
+		else
+			throw std::runtime_error("No such file or directory: " + p);
+	}
+	std::sort(files.begin(), files.end());
+	files.erase(std::unique(files.begin(), files.end()), files.end());
+
+	std::map<std::string, int> known;
+	for (int i = 0; i < (int)sources.size(); i++)
+		known[sources[i].path] = i;
+
+	std::vector<int> selected, stale;
+	for (std::string const& f : files){
+		uint64_t const size = fs::file_size(f);
+		int64_t const mtime = fs::last_write_time(f).time_since_epoch().count();
+		auto const it = known.find(f);
+		int i;
+		if (it == known.end()){
+			i = sources.size();
+			sources.push_back(Source{f, size, mtime, {}, {}});
+			stale.push_back(i);
+		} else {
+			i = it->second;
+			if (sources[i].size != size || sources[i].mtime != mtime){
+				sources[i].size = size;
+				sources[i].mtime = mtime;
+				stale.push_back(i);
+			}
+		}
+		selected.push_back(i);
+	}
+
+	parallelFor(stale.size(), threads, [&](int const i){
+		parse(sources[stale[i]]);
+	});
+
+	// Merge the selected sources, mapping their configurations onto one list.
+	// A sweep logs every run both to extra_data and to the IOHprofiler files,
+	// so the IOHprofiler rows only count for cells no run record covers.
+	std::map<std::string, int> configIds;
+	configs.clear();
+	rows.clear();
+	std::set<std::tuple<int,int,int> > recorded; // Config, function, D
+	for (int pass = 0; pass < 2; pass++)
+		for (int i : selected){
+			Source const& source = sources[i];
+			int function, D;
+			if (isIOH(source.path, function, D) != (pass == 1))
+				continue;
+			std::vector<int> ids;
+			for (std::string const& config : source.configs){
+				auto const id = configIds.insert(std::make_pair(config, configs.size()));
+				if (id.second)
+					configs.push_back(config);
+				ids.push_back(id.first->second);
+			}
+			for (ResultRow row : source.rows){
+				row.config = ids[row.config];
+				if (pass == 0)
+					recorded.insert(std::make_tuple(row.config, row.function, row.D));
+				else if (recorded.count(std::make_tuple(row.config, row.function, row.D)))
+					continue;
+				rows.push_back(row);
+			}
+		}
+	return stale.size();
+}
+
+std::vector<std::string> const& ResultIndex::getConfigs() const {
+	return configs;
+}
+
+std::vector<ResultRow> const& ResultIndex::getRows() const {
+	return rows;
+}
+
+/*		Queries 		*/
+std::vector<ResultGroup> ResultIndex::groups(std::function<bool (ResultRow const&)> const filter, int const threads) const {
+	std::vector<ResultRow> selected;
+	for (ResultRow const& row : rows)
+		if (filter(row))
+			selected.push_back(row);
+
+	// Sorted on function, D and config, so groups and cells are contiguous
+	auto const key = [](ResultRow const& r){ return std::make_tuple(r.function, r.D, r.config, r.bestF); };
+	std::sort(selected.begin(), selected.end(), [&key](ResultRow const& a, ResultRow const& b){ return key(a) < key(b); });
+
+	std::vector<ResultGroup> groups;
+	std::vector<std::size_t> starts;
+	for (std::size_t i = 0; i < selected.size(); i++){
+		ResultRow const& r = selected[i];
+		if (groups.empty() || groups.back().function != r.function || groups.back().D != r.D || groups.back().config != r.config){
+			groups.push_back(ResultGroup{r.config, r.function, r.D, 0, 0., 0., 0., false});
+			starts.push_back(i);
+		}
+	}
+	starts.push_back(selected.size());
+
+	parallelFor(groups.size(), threads, [&](int const g){
+		std::size_t const n = starts[g+1] - starts[g];
+		auto const at = [&](std::size_t const i){ return selected[starts[g] + i].bestF; };
+		groups[g].runs = n;
+		groups[g].best = at(0);
+		groups[g].median = n % 2 ? at(n/2) : (at(n/2-1) + at(n/2)) / 2.;
+	});
+
+	std::vector<std::size_t> cells;
+	for (std::size_t g = 0; g < groups.size(); g++)
+		if (g == 0 || groups[g].function != groups[g-1].function || groups[g].D != groups[g-1].D)
+			cells.push_back(g);
+	cells.push_back(groups.size());
+
+	parallelFor(cells.size() - 1, threads, [&](int const c){
+		std::vector<ResultGroup*> cell;
+		for (std::size_t g = cells[c]; g < cells[c+1]; g++)
+			cell.push_back(&groups[g]);
+		std::sort(cell.begin(), cell.end(), [](ResultGroup const* a, ResultGroup const* b){ return a->median < b->median; });
+		for (std::size_t i = 0; i < cell.size();){
+			std::size_t j = i;
+			while (j < cell.size() && cell[j]->median == cell[i]->median)
+				j++;
+			for (std::size_t k = i; k < j; k++){
+				cell[k]->rank = (i + j + 1) / 2.; // Mean of the ranks i+1..j
+				cell[k]->win = i == 0;
+			}
+			i = j;
+		}
+	});
+
+	return groups;
+}
@@ -1,11 +1,16 @@
 #include "rng.h"
 #include <algorithm>
+#include <cmath>
 
 RNG::RNG()
 : rng(dev()), boolDist(0.5){
 
 } 
 
+void RNG::seed(unsigned int const s){
+	rng.seed(s);
+}
+
 bool RNG::randBool(){
 	return boolDist(rng);
 }
@@ -15,6 +20,19 @@ double RNG::randDouble(double start, double end){
 	return dist(rng);
 }
 
+// One 32 bit draw per value instead of the two and the long double
+// arithmetic of std::generate_canonical; a resolution of 2^-32 is plenty
+// for the random factors of the updates
+void RNG::uniformFill(std::vector<double>& values, double const start, double const end){
+	uniformFill(values.data(), values.data() + values.size(), start, end);
+}
+
+void RNG::uniformFill(double* const first, double* const last, double const start, double const end){
+	double const step = (end - start) / 4294967296.;
+	for (double* value = first; value != last; value++)
+		*value = start + rng() * step;
+}
+
 int RNG::randInt(int start, int end){
 	std::uniform_int_distribution<int> dist(start, end);
 	return dist(rng);
@@ -25,6 +43,28 @@ double RNG::normalDistribution(double mean, double stdDev){
 	return N(rng);
 }
 
+// Box-Muller: the draws go in first as pairs of uniforms, which are then
+// turned into pairs of normals in one pass without branches
+void RNG::normalFill(double* const first, double* const last){
+	int const pairs = (last - first) / 2;
+	double const scale = 1. / 4294967296.;
+	for (int i = 0; i < 2 * pairs; i++)
+		first[i] = rng() * scale;
+
+	#pragma omp simd
+	for (int k = 0; k < pairs; k++){
+		double const r = std::sqrt(-2. * std::log(first[2 * k] + scale)); // Of a value in (0, 1], so finite
+		double const angle = 2. * M_PI * first[2 * k + 1];
+		first[2 * k] = r * std::cos(angle);
+		first[2 * k + 1] = r * std::sin(angle);
+	}
+
+	if (first + 2 * pairs != last){ // An odd count leaves one value to a pair of its own
+		double const r = std::sqrt(-2. * std::log(rng() * scale + scale));
+		*(last - 1) = r * std::cos(2. * M_PI * (rng() * scale));
+	}
+}
+
 double RNG::cauchyDistribution(double a, double b){
 	std::cauchy_distribution<double> C(a,b);
 	return C(rng);
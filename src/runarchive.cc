@@ -0,0 +1,376 @@
+#include "runarchive.h"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <cstdio>
+#include <iostream>
+#include <experimental/filesystem>
+
+constexpr char ARCHIVE_MAGIC[8] = {'P','S','O','D','E','A','R','C'};
+constexpr uint32_t ARCHIVE_VERSION = 2; // Adds the number of correction rates per row
+constexpr int LEGACY_RATES = 3; // Per row in version 1 archives
+
+/*		Codec 		*/
+static void putVarint(std::string& out, uint64_t v){
+	while (v >= 0x80){
+		out.push_back(char(v | 0x80));
+		v >>= 7;
+	}
+	out.push_back(char(v));
+}
+
+static uint64_t getVarint(std::string const& in, std::size_t& pos){
+	uint64_t v = 0;
+	for (int shift = 0; pos < in.size(); shift += 7){
+		uint8_t const b = in[pos++];
+		v |= uint64_t(b & 0x7f) << shift;
+		if (!(b & 0x80))
+			return v;
+	}
+	throw std::runtime_error("Truncated archive");
+}
+
+static std::string encodeInts(std::vector<int> const& values){ // Delta + zigzag + varint
+	std::string out;
+	int64_t previous = 0;
+	for (int v : values){
+		int64_t const delta = v - previous;
+		putVarint(out, (uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+		previous = v;
+	}
+	return out;
+}
+
+static std::vector<int> decodeInts(std::string const& in, std::size_t& pos, std::size_t const n){
+	std::vector<int> values(n);
+	int64_t previous = 0;
+	for (std::size_t i = 0; i < n; i++){
+		uint64_t const z = getVarint(in, pos);
+		previous += int64_t(z >> 1) ^ -int64_t(z & 1);
+		values[i] = previous;
+	}
+	return values;
+}
+
+// XOR with the previous value; a header byte holds the number of leading zero
+// bytes and of meaningful bytes, 0 means the value did not change
+static std::string encodeDoubles(std::vector<double> const& values){
+	std::string out;
+	uint64_t previous = 0;
+	for (double d : values){
+		uint64_t bits;
+		std::memcpy(&bits, &d, 8);
+		uint64_t const x = bits ^ previous;
+		previous = bits;
+		if (x == 0){
+			out.push_back(0);
+			continue;
+		}
+		int const leading = __builtin_clzll(x) / 8;
+		int const trailing = __builtin_ctzll(x) / 8;
+		int const meaningful = 8 - leading - trailing;
+		out.push_back(char((leading << 4) | meaningful));
+		for (int b = 0; b < meaningful; b++)
+			out.push_back(char(x >> (8 * (trailing + b))));
+	}
+	return out;
+}
+
+static std::vector<double> decodeDoubles(std::string const& in, std::size_t const n){
+	std::vector<double> values(n);
+	std::size_t pos = 0;
+	uint64_t previous = 0;
+	for (std::size_t i = 0; i < n; i++){
+		if (pos >= in.size())
+			throw std::runtime_error("Truncated archive");
+		uint8_t const header = in[pos++];
+		if (header != 0){
+			int const leading = header >> 4;
+			int const meaningful = header & 0x0f;
+			int const trailing = 8 - leading - meaningful;
+			if (pos + meaningful > in.size())
+				throw std::runtime_error("Truncated archive");
+			uint64_t x = 0;
+			for (int b = 0; b < meaningful; b++)
+				x |= uint64_t(uint8_t(in[pos++])) << (8 * (trailing + b));
+			previous ^= x;
+		}
+		std::memcpy(&values[i], &previous, 8);
+	}
+	return values;
+}
+
+static void putSection(std::ofstream& out, std::string const& section){
+	uint64_t const size = section.size();
+	out.write(reinterpret_cast<char const*>(&size), 8);
+	out.write(section.data(), size);
+}
+
+static std::string getSection(std::string const& file, std::size_t& pos){
+	uint64_t size;
+	if (pos + 8 > file.size())
+		throw std::runtime_error("Truncated archive");
+	std::memcpy(&size, file.data() + pos, 8);
+	pos += 8;
+	if (pos + size > file.size())
+		throw std::runtime_error("Truncated archive");
+	std::string const section = file.substr(pos, size);
+	pos += size;
+	return section;
+}
+
+/*		Extra data 		*/
+int extraDataRates(std::vector<double> const& values){
+	if (values.size() < 2 || values[1] < 1 || values[1] != int(values[1]))
+		return -1;
+	int const rates = int(values.size()) - 2 - int(values[1]) - 2;
+	return rates >= 0 ? rates : -1;
+}
+
+bool parseExtraData(std::vector<double> const& values, RunRecord& record){
+	int const rates = extraDataRates(values);
+	if (rates < 0)
+		return false;
+	record.function = values[0];
+	record.D = values[1];
+	record.percCorrected.assign(values.begin() + 2, values.begin() + 2 + rates);
+	record.bestX.assign(values.begin() + 2 + rates, values.end() - 2);
+	record.bestF = values[values.size()-2];
+	record.evaluations = values.back();
+	return true;
+}
+
+/*		Writer 		*/
+RunArchiveWriter::RunArchiveWriter(std::string const filename, bool const resume)
+	: filename(filename), resume(resume), closed(false){
+	if (!resume)
+		return;
+
+	if (std::ifstream(filename)){
+		RunArchiveReader const archive(filename);
+		for (int i = 0; i < archive.size(); i++)
+			addLocked(archive.getRow(i));
+	}
+
+	// Only whole lines count, a crash can only have torn the last one
+	std::string const journalFile = filename + ".journal";
+	std::ifstream in(journalFile);
+	std::string line;
+	std::size_t kept = 0;
+	while (std::getline(in, line) && !in.eof()){
+		std::istringstream tokens(line);
+		RunRecord record;
+		tokens >> record.config;
+		std::vector<double> values((std::istream_iterator<double>(tokens)), std::istream_iterator<double>());
+		if (parseExtraData(values, record))
+			addLocked(record);
+		kept += line.size() + 1;
+	}
+	in.close();
+
+	if (std::experimental::filesystem::exists(journalFile))
+		std::experimental::filesystem::resize_file(journalFile, kept);
+	journal.open(journalFile, std::ios::app);
+}
+
+RunArchiveWriter::~RunArchiveWriter(){
+	close();
+}
+
+void RunArchiveWriter::add(RunRecord const& record){
+	std::lock_guard<std::mutex> lock(mutex);
+	addLocked(record);
+	if (!resume)
+		return;
+
+	std::ostringstream line;
+	line.precision(17);
+	line << record.config << ' ' << record.function << ' ' << record.D;
+	for (double const v : record.percCorrected)
+		line << ' ' << v;
+	for (double const v : record.bestX)
+		line << ' ' << v;
+	line << ' ' << record.bestF << ' ' << record.evaluations << '\n';
+	journal << line.str() << std::flush;
+}
+
+void RunArchiveWriter::addLocked(RunRecord const& record){
+	auto const id = configIds.insert(std::make_pair(record.config, configs.size()));
+	if (id.second)
+		configs.push_back(record.config);
+
+	config.push_back(id.first->second);
+	function.push_back(record.function);
+	D.push_back(record.bestX.size());
+	evaluations.push_back(record.evaluations);
+	bestF.push_back(record.bestF);
+	bestX.insert(bestX.end(), record.bestX.begin(), record.bestX.end());
+	rates.push_back(record.percCorrected.size());
+	percCorrected.insert(percCorrected.end(), record.percCorrected.begin(), record.percCorrected.end());
+}
+
+int RunArchiveWriter::importLegacy(std::string const datFile, std::string const config){
+	std::ifstream in(datFile);
+	std::string line;
+	int rows = 0;
+	while (std::getline(in, line)){
+		std::istringstream tokens(line);
+		std::vector<double> values((std::istream_iterator<double>(tokens)), std::istream_iterator<double>());
+		RunRecord record;
+		if (!parseExtraData(values, record))
+			continue;
+		record.config = config;
+		add(record);
+		rows++;
+	}
+	return rows;
+}
+
+void RunArchiveWriter::close(){
+	std::lock_guard<std::mutex> lock(mutex);
+	if (closed)
+		return;
+	closed = true;
+
+	// Written next to the archive and renamed over it, so a crash keeps the previous archive
+	std::ofstream out(filename + ".tmp", std::ios::binary | std::ios::trunc);
+	uint32_t const header[3] = {ARCHIVE_VERSION, uint32_t(config.size()), uint32_t(configs.size())};
+	out.write(ARCHIVE_MAGIC, 8);
+	out.write(reinterpret_cast<char const*>(header), sizeof(header));
+
+	std::string dictionary;
+	for (std::string const& c : configs){
+		putVarint(dictionary, c.size());
+		dictionary += c;
+	}
+	putSection(out, dictionary);
+
+	std::vector<std::vector<int> > rows(configs.size());
+	for (int i = 0; i < (int)config.size(); i++)
+		rows[config[i]].push_back(i);
+	std::string index;
+	for (std::vector<int> const& r : rows){
+		putVarint(index, r.size());
+		index += encodeInts(r);
+	}
+	putSection(out, index);
+
+	putSection(out, encodeInts(config));
+	putSection(out, encodeInts(function));
+	putSection(out, encodeInts(D));
+	putSection(out, encodeInts(evaluations));
+	putSection(out, encodeInts(rates));
+	putSection(out, encodeDoubles(bestF));
+	putSection(out, encodeDoubles(percCorrected));
+	putSection(out, encodeDoubles(bestX));
+	out.close();
+	if (!out || std::rename((filename + ".tmp").c_str(), filename.c_str()) != 0){
+		std::cerr << "Cannot write archive " << filename << std::endl;
+		return;
+	}
+
+	if (resume){
+		journal.close();
+		std::remove((filename + ".journal").c_str());
+	}
+}
+
+/*		Reader 		*/
+RunArchiveReader::RunArchiveReader(std::string const filename){
+	std::ifstream in(filename, std::ios::binary);
+	if (!in)
+		throw std::runtime_error("Cannot open archive " + filename);
+	std::string const file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	uint32_t header[3];
+	if (file.size() < 8 + sizeof(header) || std::memcmp(file.data(), ARCHIVE_MAGIC, 8) != 0)
+		throw std::runtime_error("Not a run archive: " + filename);
+	std::memcpy(header, file.data() + 8, sizeof(header));
+	if (header[0] != 1 && header[0] != ARCHIVE_VERSION)
+		throw std::runtime_error("Unsupported archive version in " + filename);
+
+	std::size_t const nRows = header[1];
+	std::size_t const nConfigs = header[2];
+	std::size_t pos = 8 + sizeof(header);
+
+	std::string const dictionary = getSection(file, pos);
+	std::size_t p = 0;
+	for (std::size_t i = 0; i < nConfigs; i++){
+		std::size_t const length = getVarint(dictionary, p);
+		configs.push_back(dictionary.substr(p, length));
+		p += length;
+	}
+
+	std::string const indexSection = getSection(file, pos);
+	p = 0;
+	for (std::size_t i = 0; i < nConfigs; i++){
+		std::size_t const n = getVarint(indexSection, p);
+		index[configs[i]] = decodeInts(indexSection, p, n);
+	}
+
+	auto const intColumn = [&file, &pos](std::size_t const n){
+		std::size_t start = 0;
+		return decodeInts(getSection(file, pos), start, n);
+	};
+	config = intColumn(nRows);
+	function = intColumn(nRows);
+	D = intColumn(nRows);
+	evaluations = intColumn(nRows);
+	std::vector<int> const rates = header[0] == 1 ? std::vector<int>(nRows, LEGACY_RATES) : intColumn(nRows);
+	rateOffsets.resize(nRows + 1, 0);
+	for (std::size_t i = 0; i < nRows; i++)
+		rateOffsets[i+1] = rateOffsets[i] + rates[i];
+	bestF = decodeDoubles(getSection(file, pos), nRows);
+	percCorrected = decodeDoubles(getSection(file, pos), rateOffsets[nRows]);
+
+	offsets.resize(nRows + 1, 0);
+	for (std::size_t i = 0; i < nRows; i++)
+		offsets[i+1] = offsets[i] + D[i];
+	bestX = decodeDoubles(getSection(file, pos), offsets[nRows]);
+}
+
+int RunArchiveReader::size() const {
+	return config.size();
+}
+
+std::vector<std::string> RunArchiveReader::getConfigs() const {
+	return configs;
+}
+
+std::vector<int> const& RunArchiveReader::rows(std::string const config) const {
+	return index.at(config);
+}
+
+RunRecord RunArchiveReader::getRow(int const i) const {
+	RunRecord record;
+	record.config = configs[config[i]];
+	record.function = function[i];
+	record.D = D[i];
+	record.percCorrected.assign(percCorrected.begin() + rateOffsets[i], percCorrected.begin() + rateOffsets[i+1]);
+	record.bestX.assign(bestX.begin() + offsets[i], bestX.begin() + offsets[i+1]);
+	record.bestF = bestF[i];
+	record.evaluations = evaluations[i];
+	return record;
+}
+
+std::string RunArchiveReader::getConfig(int const i) const {
+	return configs[config[i]];
+}
+
+int RunArchiveReader::getFunction(int const i) const {
+	return function[i];
+}
+
+int RunArchiveReader::getD(int const i) const {
+	return D[i];
+}
+
+double RunArchiveReader::getBestF(int const i) const {
+	return bestF[i];
+}
+
+int RunArchiveReader::getEvaluations(int const i) const {
+	return evaluations[i];
+}
@@ -0,0 +1,70 @@
+#include "snapshottrigger.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#define LC(X) [](double const parameter){return new X(parameter);}
+std::map<std::string, std::function<SnapshotTrigger* (double const)>> const snapshotTriggers({
+		{"K", LC(EveryKTrigger)},
+		{"L", LC(LogSpacedTrigger)},
+		{"I", LC(ImprovementTrigger)},
+		{"C", LC(DiversityCollapseTrigger)},
+		{"F", LC(FixedFramesTrigger)},
+});
+
+SnapshotTrigger* createSnapshotTrigger(std::string const spec){
+	std::size_t const split = spec.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+	std::string const key = spec.substr(0, split);
+	double const parameter = split == std::string::npos ? 0. : std::stod(spec.substr(split));
+	return snapshotTriggers.at(key)(parameter);
+}
+
+/*		Every k iterations		*/
+bool EveryKTrigger::check(SnapshotState const& state){
+	return state.iteration % k == 0;
+}
+
+/*		Log-spaced in evaluations 		*/
+bool LogSpacedTrigger::check(SnapshotState const& state){
+	if (state.evaluations < std::pow(10., step / perDecade))
+		return false;
+
+	while (std::pow(10., step / perDecade) <= state.evaluations)
+		step++;
+	return true;
+}
+
+/*		Best fitness improvement 		*/
+ImprovementTrigger::ImprovementTrigger(double const margin)
+	: margin(margin), best(std::numeric_limits<double>::max()){}
+
+bool ImprovementTrigger::check(SnapshotState const& state){
+	if (best != std::numeric_limits<double>::max() && state.bestFitness >= best - margin * std::abs(best))
+		return false;
+
+	best = state.bestFitness;
+	return true;
+}
+
+/*		Diversity collapse 		*/
+DiversityCollapseTrigger::DiversityCollapseTrigger(double const factor)
+	: factor(factor > 0. && factor < 1. ? factor : 0.5), reference(-1.){}
+
+bool DiversityCollapseTrigger::check(SnapshotState const& state){
+	if (reference >= 0. && state.diversity >= factor * reference)
+		return false;
+
+	reference = state.diversity;
+	return true;
+}
+
+/*		Fixed number of frames 		*/
+bool FixedFramesTrigger::check(SnapshotState const& state){
+	double const spacing = frames > 1 ? double(state.evalBudget) / (frames - 1) : std::numeric_limits<double>::max();
+	if (taken >= frames || state.evaluations < taken * spacing)
+		return false;
+
+	while (taken < frames && taken * spacing <= state.evaluations)
+		taken++;
+	return true;
+}
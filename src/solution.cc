@@ -25,11 +25,10 @@ void Solution::setFitness(double const f){
 	evaluated=true;
 }
 
-double Solution::evaluate(std::shared_ptr<IOHprofiler_problem<double> > problem, std::shared_ptr<IOHprofiler_csv_logger> logger) {
+double Solution::evaluate(EvaluationBuffer& evaluations) {
 	if (!evaluated){
 		evaluated = true;		
-		fitness = problem->evaluate(x);
-		logger->do_log(problem->loggerCOCOInfo());
+		fitness = evaluations.evaluate(x);
 	} 
 
 	return fitness;
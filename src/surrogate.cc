@@ -0,0 +1,71 @@
+#include "surrogate.h"
+#include "solution.h"
+#include "parallel.h"
+#include <algorithm>
+#include <limits>
+
+Surrogate::Surrogate(int const D): D(D){}
+Surrogate::~Surrogate(){}
+
+void Surrogate::predict(std::vector<Solution*> const& points, std::vector<double>& predicted, int const threads) const{
+	predicted.resize(points.size());
+	parallelFor(points.size(), threads, [&](int const i){
+		predicted[i] = predict(points[i]->getX());
+	});
+}
+
+#define LC(X) [](int const D){return new X(D);}
+std::map<std::string, std::function<Surrogate* (int const)>> const surrogates({
+		{"K", LC(KNNSurrogate)},
+});
+
+KNNSurrogate::KNNSurrogate(int const D)
+	: Surrogate(D), k(5), capacity(2000), next(0){
+}
+
+// Adding is all the fitting there is
+void KNNSurrogate::add(std::vector<double> const& x, double const f){
+	if ((int)fitness.size() < capacity){
+		points.insert(points.end(), x.begin(), x.end());
+		fitness.push_back(f);
+		return;
+	}
+	std::copy(x.begin(), x.end(), points.begin() + next * D);
+	fitness[next] = f;
+	next = (next + 1) % capacity;
+}
+
+bool KNNSurrogate::ready() const {
+	return (int)fitness.size() >= k;
+}
+
+double KNNSurrogate::predict(std::vector<double> const& x) const {
+	// The k nearest so far, sorted on distance by insertion
+	std::vector<double> nearest(k, std::numeric_limits<double>::max());
+	std::vector<int> index(k, -1);
+	int const N = fitness.size();
+	for (int r = 0; r < N; r++){
+		double const* const p = points.data() + r * D;
+		double d = 0.;
+		for (int j = 0; j < D; j++)
+			d += (p[j] - x[j]) * (p[j] - x[j]);
+		if (d == 0.)
+			return fitness[r];
+		if (d >= nearest[k - 1])
+			continue;
+		int m = k - 1;
+		for (; m > 0 && nearest[m - 1] > d; m--){
+			nearest[m] = nearest[m - 1];
+			index[m] = index[m - 1];
+		}
+		nearest[m] = d;
+		index[m] = r;
+	}
+
+	double weights = 0., sum = 0.;
+	for (int m = 0; m < k && index[m] >= 0; m++){
+		weights += 1. / nearest[m];
+		sum += fitness[index[m]] / nearest[m];
+	}
+	return sum / weights;
+}
@@ -0,0 +1,185 @@
+#include "sweepmanifest.h"
+#include "util.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <experimental/filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+static uint64_t fnv1a(std::string const& s){
+	uint64_t h = 14695981039346656037ull;
+	for (unsigned char c : s){
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+static std::string hex(uint64_t const v){
+	char buffer[17];
+	std::snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)v);
+	return buffer;
+}
+
+// "1-24" or "5,20"
+static std::vector<int> parseRange(std::string const& value){
+	std::vector<int> values;
+	std::istringstream in(value);
+	std::string part;
+	while (std::getline(in, part, ',')){
+		std::size_t const dash = part.find('-');
+		int const first = std::stoi(part.substr(0, dash));
+		int const last = dash == std::string::npos ? first : std::stoi(part.substr(dash + 1));
+		for (int v = first; v <= last; v++)
+			values.push_back(v);
+	}
+	return values;
+}
+
+static std::string trim(std::string const& s){
+	std::size_t const begin = s.find_first_not_of(" \t\r");
+	return begin == std::string::npos ? "" : s.substr(begin, s.find_last_not_of(" \t\r") - begin + 1);
+}
+
+/*		Unit 		*/
+uint64_t WorkUnit::hash() const {
+	std::ostringstream key;
+	key << config << '|' << problem << '|' << instance << '|' << D << '|' << run << '|' << seed;
+	return fnv1a(key.str());
+}
+
+uint32_t WorkUnit::rngSeed() const {
+	uint64_t const h = hash();
+	return uint32_t(h ^ (h >> 32));
+}
+
+/*		Manifest 		*/
+// Line: <hash> <config> <problem> <instance> <D> <run> <seed> <evaluations> <bestF> <checksum of the rest>
+// First line: seed <seed> <checksum>
+SweepManifest::SweepManifest(std::string const filename)
+	: filename(filename), seed(0){
+
+	std::experimental::filesystem::path const folder = std::experimental::filesystem::path(filename).parent_path();
+	if (!folder.empty())
+		std::experimental::filesystem::create_directories(folder);
+
+	std::ifstream in(filename);
+	std::string line;
+	bool terminated = true, seeded = false;
+	while (std::getline(in, line)){
+		terminated = !in.eof();
+		std::size_t const split = line.find_last_of(' ');
+		if (split == std::string::npos || hex(fnv1a(line.substr(0, split))) != line.substr(split + 1))
+			continue; // Torn by a crash
+		if (line.compare(0, 5, "seed ") == 0){
+			seed = std::stoull(line.substr(5, split - 5));
+			seeded = true;
+		} else
+			done.insert(std::stoull(line.substr(0, line.find(' ')), NULL, 16));
+	}
+	in.close();
+
+	if (!terminated) // End the torn line so the next record starts on a line of its own
+		std::ofstream(filename, std::ios::app) << '\n';
+
+	if (!seeded){ // A fresh sweep; manifests from before the seed was kept used 0
+		if (done.empty())
+			seed = (uint64_t(std::random_device()()) << 32) | std::random_device()();
+		append("seed " + std::to_string(seed));
+	}
+}
+
+void SweepManifest::append(std::string const record){
+	std::string const line = record + ' ' + hex(fnv1a(record)) + '\n';
+	int const fd = open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+	if (fd < 0)
+		throw std::runtime_error("Cannot open sweep manifest " + filename);
+	bool const written = write(fd, line.data(), line.size()) == (ssize_t)line.size() && fsync(fd) == 0;
+	close(fd);
+	if (!written)
+		throw std::runtime_error("Cannot write sweep manifest " + filename);
+}
+
+WorkUnit SweepManifest::unit(std::string const config, int const problem, int const instance, int const D, int const run) const {
+	return WorkUnit{config, problem, instance, D, run, seed};
+}
+
+std::vector<SweepBatch> SweepManifest::pending(std::string const templateFile, std::string const config, int const runs){
+	if (size() == 0)
+		return {SweepBatch{generateConfig(templateFile, config), runs}};
+
+	std::vector<std::string> lines;
+	std::map<std::string, std::string> values;
+	std::ifstream in(templateFile);
+	std::string line;
+	while (std::getline(in, line)){
+		lines.push_back(line);
+		std::size_t const split = line.find('=');
+		if (split != std::string::npos)
+			values[trim(line.substr(0, split))] = trim(line.substr(split + 1));
+	}
+
+	// Every batch logs to a folder of its own, so the IOH logger does not rename the result folder
+	namespace fs = std::experimental::filesystem;
+	std::string resume;
+	for (int n = 1; resume.empty() || fs::exists(resume); n++)
+		resume = values["output_directory"] + "/resume-" + std::to_string(n);
+	fs::create_directories("configurations");
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<SweepBatch> batches;
+	for (int const problem : parseRange(values["problem_id"]))
+		for (int const instance : parseRange(values["instance_id"]))
+			for (int const D : parseRange(values["dimension"])){
+				int missing = 0;
+				for (int run = 0; run < runs; run++)
+					missing += done.count(unit(config, problem, instance, D, run).hash()) == 0;
+				if (missing == 0)
+					continue;
+
+				std::string const cell = "f" + std::to_string(problem) + "_i" + std::to_string(instance) + "_DIM" + std::to_string(D);
+				std::map<std::string, std::string> const cellValues = {
+					{"problem_id", std::to_string(problem)},
+					{"instance_id", std::to_string(instance)},
+					{"dimension", std::to_string(D)},
+					{"output_directory", resume + "/" + cell}};
+				std::string const cfgFile = "configurations/" + config + "_" + cell + ".ini";
+				std::ofstream out(cfgFile);
+				for (std::string const& l : lines){
+					std::size_t const split = l.find('=');
+					auto const value = split == std::string::npos ? cellValues.end() : cellValues.find(trim(l.substr(0, split)));
+					out << (value == cellValues.end() ? l : value->first + " = " + value->second) << std::endl;
+				}
+				out << "result_folder = " + config << std::endl
+					<< "algorithm_name = " + config << std::endl;
+				batches.push_back(SweepBatch{cfgFile, missing});
+			}
+	return batches;
+}
+
+WorkUnit SweepManifest::next(std::string const config, int const problem, int const instance, int const D){
+	std::lock_guard<std::mutex> lock(mutex);
+	int& run = runs[std::make_tuple(config, problem, instance, D)];
+	while (done.count(unit(config, problem, instance, D, run).hash()) > 0)
+		run++;
+	return unit(config, problem, instance, D, run++);
+}
+
+void SweepManifest::complete(WorkUnit const& unit, int const evaluations, double const bestF){
+	std::ostringstream record;
+	record.precision(17);
+	record << hex(unit.hash()) << ' ' << unit.config << ' ' << unit.problem << ' ' << unit.instance << ' '
+		<< unit.D << ' ' << unit.run << ' ' << unit.seed << ' ' << evaluations << ' ' << bestF;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	append(record.str());
+	done.insert(unit.hash());
+}
+
+int SweepManifest::size(){
+	std::lock_guard<std::mutex> lock(mutex);
+	return done.size();
+}
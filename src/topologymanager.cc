@@ -1,14 +1,21 @@
 #include "topologymanager.h"
 #include "particle.h"
+#include "particleupdatesettings.h"
 #include "rng.h"
 #include <algorithm>
 #include <iostream>
 
+typedef NeighborhoodGraph::Edge Edge;
+
 /*		Base 		*/
-TopologyManager::TopologyManager(std::vector<Particle*> const & particles) :particles(particles){}
+TopologyManager::TopologyManager(std::vector<Particle*> const & particles) :particles(particles), graph(particles){
+	for (int i = 0; i < (int)particles.size(); i++)
+		particles[i]->setNeighborhood(&graph, i);
+}
 
-#define LC(X) [](std::vector<Particle*> const& p){return new X(p);}
-std::map<std::string, std::function<TopologyManager* (std::vector<Particle*> const&)>> const topologies{
+#define LC(X) [](std::vector<Particle*> const& p, std::map<int,double> const parameters){return new X(p);}
+#define LCP(X) [](std::vector<Particle*> const& p, std::map<int,double> const parameters){return new X(p, parameters);}
+std::map<std::string, std::function<TopologyManager* (std::vector<Particle*> const&, std::map<int,double> const)>> const topologies{
 	{"L", LC(LbestTopologyManager)},
 	{"G", LC(GbestTopologyManager)},
 	{"R", LC(RandomTopologyManager)},
@@ -16,7 +23,7 @@ std::map<std::string, std::function<TopologyManager* (std::vector<Particle*> con
 	{"W", LC(WheelTopologyManager)},
 	{"I", LC(IncreasingTopologyManager)},
 	{"D", LC(DecreasingTopologyManager)},
-	{"M", LC(MultiSwarmTopologyManager)},
+	{"M", LCP(MultiSwarmTopologyManager)},
 };
 
 TopologyManager::~TopologyManager() = default;
@@ -25,40 +32,33 @@ void TopologyManager::update(double progress){
 	// default: do nothing. (static topologies)
 }
 
+NeighborhoodGraph const& TopologyManager::getGraph() const {
+	return graph;
+}
+
 /*		Lbest 		*/
 LbestTopologyManager::LbestTopologyManager(std::vector<Particle*> const & particles)
 	:TopologyManager(particles){
 	int const popSize = particles.size();
+	std::vector<Edge> edges;
 	for (int i = 0; i < popSize; i++){
-		if (i ==0)
-			particles[0]->addNeighbor(particles[popSize-1]);
-		else
-			particles[i]->addNeighbor(particles[i-1]);
-
-		if (i == popSize -1)
-			particles[i]->addNeighbor(particles[0]);
-		else
-			particles[i]->addNeighbor(particles[i+1]);
+		edges.push_back(Edge(i, (i + popSize - 1) % popSize));
+		edges.push_back(Edge(i, (i + 1) % popSize));
 	}
+	graph.assign(edges);
 }
 
 /*		Gbest 		*/
 GbestTopologyManager::GbestTopologyManager(std::vector<Particle*> const & particles)
 	:TopologyManager(particles){
-	int const popSize = particles.size();
-	for (int i = 0; i < popSize; i++){
-		for (int j = 0; j < popSize; j++){
-			if (i != j){
-				particles[i]->addNeighbor(particles[j]);
-			}
-		}
-	}
+	graph.assignComplete(); // Stores no edges
 }
 
 /*		Random 		*/
 RandomTopologyManager::RandomTopologyManager(std::vector<Particle*> const & particles)
 	:TopologyManager(particles), connections(3){
 	int const popSize = particles.size();
+	std::vector<Edge> edges;
 
 	for (int i = 0; i < popSize; i++){
 		std::vector<int> possibilities;
@@ -71,10 +71,11 @@ RandomTopologyManager::RandomTopologyManager(std::vector<Particle*> const & part
 
 		for (int j = 0; j < connections; j++){
 			int index = rng.randInt(0,possibilities.size()-1);
-			particles[i]->addNeighbor(particles[possibilities[index]]);
+			edges.push_back(Edge(i, possibilities[index]));
 			possibilities.erase(possibilities.begin() + index);
 		}
 	}
+	graph.assign(edges);
 }
 
 /*		Von Neumann		*/
@@ -85,40 +86,30 @@ VonNeumannTopologyManager::VonNeumannTopologyManager(std::vector<Particle*> cons
 	    rows--;
   	}
   	int const columns = particles.size() / rows;
+	std::vector<Edge> edges;
 
 	for (int i = 0; i < rows; i++){
 		for (int j = 0; j < columns; j++){
-			if (i != rows-1)
-				particles[i * columns + j]->addNeighbor(particles[(i+1) * columns + j]);
-			else 
-				particles[i * columns + j]->addNeighbor(particles[j]);
-
-			if (i != 0)
-				particles[i * columns + j]->addNeighbor(particles[(i-1) * columns + j]);
-			else 
-				particles[i * columns + j]->addNeighbor(particles[(rows-1)* columns + j]);
-
-			if (j != columns-1)
-				particles[i * columns + j]->addNeighbor(particles[i * columns + (j+1)]);
-			else 
-				particles[i * columns + j]->addNeighbor(particles[i * columns + 0]);
-
-			if (j != 0)
-				particles[i * columns + j]->addNeighbor(particles[i * columns + (j-1)]);
-			else 
-				particles[i * columns + j]->addNeighbor(particles[i * columns + (columns -1)]);
+			int const self = i * columns + j;
+			edges.push_back(Edge(self, ((i+1) % rows) * columns + j));
+			edges.push_back(Edge(self, ((i+rows-1) % rows) * columns + j));
+			edges.push_back(Edge(self, i * columns + (j+1) % columns));
+			edges.push_back(Edge(self, i * columns + (j+columns-1) % columns));
 		}
 	}
+	graph.assign(edges);
 }
 
 /*		Wheel 		*/
 WheelTopologyManager::WheelTopologyManager(std::vector<Particle*> const & particles)
 	:TopologyManager(particles){
 	int const popSize = particles.size();
+	std::vector<Edge> edges;
 	for (int i = 1; i < popSize; i++){
-		particles[i]->addNeighbor(particles[0]);
-		particles[0]->addNeighbor(particles[i]);
+		edges.push_back(Edge(i, 0));
+		edges.push_back(Edge(0, i));
 	}
+	graph.assign(edges);
 }
 
 /*		Increasing connectivity 	*/
@@ -127,17 +118,12 @@ IncreasingTopologyManager::IncreasingTopologyManager(std::vector<Particle*> cons
 	maxConnectivity = particles.size() -1;
 
 	int const popSize = particles.size();
+	std::vector<Edge> edges;
 	for (int i = 0; i < popSize; i++){
-		if (i ==0)
-			particles[0]->addNeighbor(particles[popSize-1]);
-		else
-			particles[i]->addNeighbor(particles[i-1]);
-
-		if (i == popSize -1)
-			particles[i]->addNeighbor(particles[0]);
-		else
-			particles[i]->addNeighbor(particles[i+1]);
+		edges.push_back(Edge(i, (i + popSize - 1) % popSize));
+		edges.push_back(Edge(i, (i + 1) % popSize));
 	}
+	graph.assign(edges);
 }
 
 void IncreasingTopologyManager::update(double progress){
@@ -147,23 +133,30 @@ void IncreasingTopologyManager::update(double progress){
 
 	if (newConnectivity > currentConnectivity){
 		int const newNeighbors = newConnectivity - currentConnectivity;
-		std::vector<Particle*> possibilities;
+		std::vector<int> possibilities;
+		std::vector<Edge> edges;
 
 		for (int i = 0; i < popSize; i++){
-			for (int k = 0; k < popSize; k++){
-				if (k != i && !particles[i]->isNeighbor(particles[k])){
-					possibilities.push_back(particles[k]);
+			NeighborhoodGraph::Row const neighbors = graph.getNeighbors(i);
+			NeighborhoodGraph::Row::iterator n = neighbors.begin();
+			for (int k = 0; k < popSize; k++){ // Rows are sorted, so the non-neighbors follow from one merge
+				while (n != neighbors.end() && *n < k)
+					++n;
+				if (k != i && (n == neighbors.end() || *n != k)){
+					possibilities.push_back(k);
 				}
 			}
 
 			for (int j = 0; j < newNeighbors; j++){
 				int randIndex = rng.randInt(0,possibilities.size()-1);
-				particles[i]->addNeighbor(possibilities[randIndex]);
-				possibilities.erase(possibilities.begin() + randIndex);			
+				edges.push_back(Edge(i, possibilities[randIndex]));
+				possibilities[randIndex] = possibilities.back();
+				possibilities.pop_back();
 			}			
 			possibilities.clear();
 			
 		}
+		graph.add(edges);
 		currentConnectivity = newConnectivity;
 	}
 }
@@ -174,12 +167,7 @@ DecreasingTopologyManager::DecreasingTopologyManager(std::vector<Particle*> cons
 	int const popSize = particles.size();
 	maxConnectivity = popSize;
 	currentConnectivity = popSize-1;
-	for (int i = 0; i < popSize; i++){
-		for (int j = 0; j < popSize; j++){
-			if (i != j)
-				particles[i]->addNeighbor(particles[j]);
-		}
-	}
+	graph.assignComplete(); // Edges are stored from the first removal on
 }
 
 void DecreasingTopologyManager::update(double progress){
@@ -189,70 +177,54 @@ void DecreasingTopologyManager::update(double progress){
 
 	if (newConnectivity < currentConnectivity){
 		int const removeNeighbors = currentConnectivity - newConnectivity;
-		std::vector<Particle*> possibilities;
+		std::vector<int> possibilities;
+		std::vector<Edge> edges;
 
 		for (int i = 0; i < popSize; i++){
-			for (int k = 0; k < popSize; k++){
-				if (i != k && !(i == 0 && k == popSize-1) && k != i-1  && k != ((i+1)%popSize)
-					&& particles[i]->isNeighbor(particles[k])){
-					possibilities.push_back(particles[k]);
+			for (int k : graph.getNeighbors(i)){ // The ring neighbors are kept
+				if (i != k && k != (i+popSize-1)%popSize && k != (i+1)%popSize){
+					possibilities.push_back(k);
 				}
 			}
 
 			for (int k = 0; k < removeNeighbors; k++){
 				int randIndex = rng.randInt(0,possibilities.size()-1);
-				particles[i]->removeNeighbor(possibilities[randIndex]);
-				possibilities.erase(possibilities.begin() + randIndex);
+				edges.push_back(Edge(i, possibilities[randIndex]));
+				possibilities[randIndex] = possibilities.back();
+				possibilities.pop_back();
 			}
 			possibilities.clear();
 		}
+		graph.remove(edges);
 		currentConnectivity = newConnectivity;
 	}
 }
 
 
 /* Dynamic multi-swarm */
-MultiSwarmTopologyManager::MultiSwarmTopologyManager(std::vector<Particle*> const & ptcs)
-	:TopologyManager(ptcs), clusterSize(3), count(0){
-	createClusters();
+MultiSwarmTopologyManager::MultiSwarmTopologyManager(std::vector<Particle*> const & ptcs, std::map<int,double> parameters)
+	:TopologyManager(ptcs),
+	clusterSize(std::max(1., parameters.find(Setting::S_MS_CLUSTER_SIZE) != parameters.end() ? parameters[Setting::S_MS_CLUSTER_SIZE] : MS_CLUSTER_SIZE_DEFAULT)),
+	period(std::max(1., parameters.find(Setting::S_MS_REGROUP_PERIOD) != parameters.end() ? parameters[Setting::S_MS_REGROUP_PERIOD] : MS_REGROUP_PERIOD_DEFAULT)),
+	count(0), clusterOf(ptcs.size()){
+	// Full clusters, the last one takes the remainder
+	int const clusters = std::max(1, (int)particles.size() / clusterSize);
+	for (int i = 0; i < (int)particles.size(); i++)
+		clusterOf[i] = std::min(i / clusterSize, clusters - 1);
+	regroup();
 }
 
-void MultiSwarmTopologyManager::createClusters(){
-	std::vector<Particle*> toInitialize = particles;
-
-	while (!toInitialize.empty()){
-		std::vector<Particle*> cluster;
-		int newClusterSize;
-
-		if ((int)toInitialize.size() >= 2 * clusterSize)
-			newClusterSize = clusterSize;
-		else 
-			newClusterSize = toInitialize.size();
-
-		cluster.reserve(newClusterSize);
-		for (int i = 0; i < newClusterSize; i++){
-			int randIndex = rng.randInt(0,toInitialize.size()-1);
-			cluster.push_back(toInitialize[randIndex]);
-			toInitialize.erase(toInitialize.begin() + randIndex);
-		}
-
-		for (int i = 0; i < (int)cluster.size(); i++){
-			for (int j = 0; j < (int)cluster.size(); j++){
-				if (i != j)
-					cluster[i]->addNeighbor(cluster[j]);
-			}
-		}
-
-		cluster.clear();
-	}
+// A shuffle of the cluster ids draws random clusters of the same sizes
+void MultiSwarmTopologyManager::regroup(){
+	for (int i = clusterOf.size() - 1; i > 0; i--)
+		std::swap(clusterOf[i], clusterOf[rng.randInt(0, i)]);
+	graph.assignClusters(clusterOf);
 }
 
 void MultiSwarmTopologyManager::update(double progress){
 	count++;
-	if (count >= 5){
-		for (Particle* p: particles)
-			p->removeAllNeighbors();
-		createClusters();
+	if (count >= period){
+		regroup();
 		count = 0;
 	}
 }
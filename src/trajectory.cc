@@ -0,0 +1,172 @@
+#include "trajectory.h"
+#include <stdexcept>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static std::size_t paddedLength(std::size_t const n){
+	return (n + 7) & ~std::size_t(7);
+}
+
+/*		Writer 		*/
+TrajectoryWriter::TrajectoryWriter(LogSink* const sink, int const N, int const D, int const problem,
+		std::string const config, int const precision)
+	: sink(sink), N(N), D(D), precision(precision), frames(0),
+	frame((N * D + N) * precision){
+
+	if (precision != 4 && precision != 8){
+		delete sink;
+		throw std::invalid_argument("Trajectory precision must be 4 or 8 bytes");
+	}
+
+	if (!sink->enabled())
+		return;
+
+	TrajectoryHeader header;
+	std::memcpy(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic));
+	header.version = TRAJECTORY_VERSION;
+	header.N = N;
+	header.D = D;
+	header.precision = precision;
+	header.problem = problem;
+	header.configLength = config.size();
+
+	std::vector<char> padded(paddedLength(config.size()), '\0');
+	std::copy(config.begin(), config.end(), padded.begin());
+
+	sink->write(reinterpret_cast<char const*>(&header), sizeof(header));
+	sink->write(padded.data(), padded.size());
+	if (!sink->good())
+		std::cerr << "Trajectory of " << config << " has no header" << std::endl;
+}
+
+TrajectoryWriter::~TrajectoryWriter(){
+	delete sink;
+}
+
+void TrajectoryWriter::put(int const index, double const value){
+	if (precision == 4){
+		float const f = value;
+		std::memcpy(frame.data() + index * 4, &f, 4);
+	} else
+		std::memcpy(frame.data() + index * 8, &value, 8);
+}
+
+// Frames before a failed write stay readable, the ones after it are dropped
+void TrajectoryWriter::written(){
+	if (sink->good())
+		frames++;
+	else
+		std::cerr << "Trajectory cut off after " << frames << " frames" << std::endl;
+}
+
+int TrajectoryWriter::size() const {
+	return frames;
+}
+
+/*		Frame 		*/
+double TrajectoryFrame::get(int const index) const {
+	if (precision == 4){
+		float f;
+		std::memcpy(&f, data + index * 4, 4);
+		return f;
+	}
+	double d;
+	std::memcpy(&d, data + index * 8, 8);
+	return d;
+}
+
+double TrajectoryFrame::getX(int const particle, int const dim) const {
+	return get(particle * D + dim);
+}
+
+std::vector<double> TrajectoryFrame::getX(int const particle) const {
+	std::vector<double> x(D);
+	for (int j = 0; j < D; j++)
+		x[j] = get(particle * D + j);
+	return x;
+}
+
+double TrajectoryFrame::getFitness(int const particle) const {
+	return get(N * D + particle);
+}
+
+/*		Reader 		*/
+TrajectoryReader::TrajectoryReader(std::string const filename)
+	: fd(-1), data(NULL), length(0){
+	fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("Cannot open trajectory " + filename);
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (std::size_t)st.st_size < sizeof(TrajectoryHeader)){
+		close(fd);
+		throw std::runtime_error("Invalid trajectory " + filename);
+	}
+
+	length = st.st_size;
+	void* const mapped = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+	if (mapped == MAP_FAILED){
+		close(fd);
+		throw std::runtime_error("Cannot map trajectory " + filename);
+	}
+	data = static_cast<char const*>(mapped);
+
+	std::memcpy(&header, data, sizeof(header));
+	// The header is checked against the mapping before anything it points to is read
+	if (std::memcmp(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic)) != 0
+			|| header.version != TRAJECTORY_VERSION
+			|| header.N == 0 || header.D == 0 || (header.precision != 4 && header.precision != 8)
+			|| sizeof(header) + paddedLength(header.configLength) > length){
+		munmap(const_cast<char*>(data), length);
+		close(fd);
+		throw std::runtime_error("Not a trajectory file: " + filename);
+	}
+
+	config.assign(data + sizeof(header), header.configLength);
+	dataOffset = sizeof(header) + paddedLength(header.configLength);
+	frameSize = (std::size_t(header.N) * header.D + header.N) * header.precision;
+}
+
+TrajectoryReader::~TrajectoryReader(){
+	munmap(const_cast<char*>(data), length);
+	close(fd);
+}
+
+int TrajectoryReader::size() const {
+	if (frameSize == 0 || length < dataOffset)
+		return 0;
+	return (length - dataOffset) / frameSize; // A partially written last frame is ignored
+}
+
+int TrajectoryReader::getN() const {
+	return header.N;
+}
+
+int TrajectoryReader::getD() const {
+	return header.D;
+}
+
+int TrajectoryReader::getProblem() const {
+	return header.problem;
+}
+
+std::string TrajectoryReader::getConfig() const {
+	return config;
+}
+
+TrajectoryFrame TrajectoryReader::frame(int const i) const {
+	if (i < 0 || i >= size())
+		throw std::out_of_range("Trajectory frame " + std::to_string(i) + " out of range");
+	return TrajectoryFrame(data + dataOffset + i * frameSize, header.N, header.D, header.precision);
+}
+
+TrajectoryReader::iterator TrajectoryReader::begin() const {
+	return iterator(this, 0);
+}
+
+TrajectoryReader::iterator TrajectoryReader::end() const {
+	return iterator(this, size());
+}
@@ -63,7 +63,9 @@ double distance(Solution const*const s1, Solution const*const s2) {
 	return std::sqrt(d);
 }
 
-std::string checkFilename(std::string const fn){
+std::string checkFilename(std::string const fn, std::string const sinkType){
+	if (sinkType != "F") // The other sinks never touch the file system
+		return fn;
 	std::string newFn = fn;
 	int i = 1;
 	while (std::experimental::filesystem::exists(newFn)){
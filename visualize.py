@@ -1,8 +1,73 @@
 import matplotlib.pyplot as plt 
 import matplotlib.animation as animation 
 from mpl_toolkits.mplot3d import Axes3D
+import numpy as np
+import mmap
+import struct
 import sys
 
+# Usage: visualize.py [trajectory.traj | --live <feed name>] (reads text frames from stdin otherwise)
+
+def read_trajectory(filename):
+	header = struct.Struct("<8sIIIIiI")
+	with open(filename, "rb") as f:
+		magic, version, N, D, precision, problem, config_length = header.unpack(f.read(header.size))
+	if magic != b"PSODETRJ":
+		sys.exit(filename + " is not a trajectory file")
+	offset = header.size + ((config_length + 7) & ~7)
+	dtype = np.float32 if precision == 4 else np.float64
+	data = np.memmap(filename, dtype=dtype, mode="r", offset=offset)
+	frame_size = N * D + N
+	frames = data[:(len(data) // frame_size) * frame_size].reshape(-1, frame_size)
+	return frames[:, :N * D].reshape(-1, N, D)
+
+# Reader for the shared memory feed of a running optimizer, see include/livefeed.h
+class LiveFeed:
+	header = struct.Struct("<8sIIIIiIQ")
+
+	def __init__(self, name):
+		self.path = "/dev/shm/" + name.lstrip("/")
+		self.map = None
+
+	def attach(self):
+		self.map = None
+		try:
+			with open(self.path, "rb") as f:
+				m = mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
+		except (OSError, ValueError):
+			return False
+		magic, version, self.N, self.D, self.slots, problem, closed, published = self.header.unpack_from(m, 0)
+		if magic != b"PSODELIV" or version != 1 or self.slots == 0:
+			return False
+		self.slot_size = 8 + (((self.N * self.D + self.N) * 4 + 7) & ~7)
+		self.next = published
+		self.map = m
+		return True
+
+	def latest(self):
+		if self.map is None or struct.unpack_from("<I", self.map, 28)[0]:
+			if not self.attach(): # Wait for the next run
+				return None
+		published = struct.unpack_from("<Q", self.map, 32)[0]
+		if published <= self.next:
+			return None
+		k = published - 1
+		offset = 64 + (k % self.slots) * self.slot_size
+		before = struct.unpack_from("<Q", self.map, offset)[0]
+		if before != 2 * k + 2:
+			return None
+		frame = np.frombuffer(self.map, dtype=np.float32, count=self.N * self.D + self.N, offset=offset + 8).copy()
+		if struct.unpack_from("<Q", self.map, offset)[0] != before: # Overwritten while copying
+			return None
+		self.next = k + 1
+		return frame[:self.N * self.D].reshape(self.N, self.D)
+
+trajectory, live = None, None
+if len(sys.argv) > 2 and sys.argv[1] == "--live":
+	live = LiveFeed(sys.argv[2])
+elif len(sys.argv) > 1:
+	trajectory = read_trajectory(sys.argv[1])
+
 fig = plt.figure() 
 ax = fig.add_subplot(1,1,1, projection='3d')
 ax.set_xlim3d([-5, 5])
@@ -19,9 +84,17 @@ sc = ax.scatter([],[],[])
 def init(): 
 	return sc
 
-# animation function 
-def animate(i): 
-	angle = i % 360
+def read_frame(i):
+	if live is not None:
+		frame = live.latest()
+		return None if frame is None else (frame[:, 0], frame[:, 1], frame[:, 2])
+
+	if trajectory is not None:
+		if i >= len(trajectory):
+			anim.event_source.stop()
+			return None
+		return trajectory[i, :, 0], trajectory[i, :, 1], trajectory[i, :, 2]
+
 	xdata, ydata, zdata = [], [], []
 	inp = sys.stdin.readline()
 	if len(inp) == 0:
@@ -34,9 +107,17 @@ def animate(i):
 		ydata.append(y) 
 		zdata.append(z) 
 		inp = sys.stdin.readline().rstrip()
+	return xdata, ydata, zdata
+
+# animation function 
+def animate(i): 
+	angle = i % 360
+	frame = read_frame(i)
+	if frame is None:
+		return sc
 
 	ax.view_init(30, int(angle))
-	sc._offsets3d = (xdata, ydata, zdata)
+	sc._offsets3d = frame
 	return sc 
 	
 # plt.axis('off') 